@@ -0,0 +1,75 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "sharded_btree.h"
+
+using namespace std;
+
+// Benchmark de escalabilidad de inserciones: compara un BTree protegido por un
+// unico mutex contra ShardedBTree (por rango y por hash) con 1..N hilos.
+// Uso: ./bench_sharded [keys_por_hilo] [M]
+
+const int SHARDS = 64;
+
+// cada hilo inserta su propio bloque de keys en orden aleatorio
+vector<vector<int>> generar(int hilos, int por_hilo) {
+  vector<vector<int>> keys(hilos);
+  for (int t = 0; t < hilos; t++) {
+    for (int i = 0; i < por_hilo; i++) keys[t].push_back(i * hilos + t);
+    shuffle(keys[t].begin(), keys[t].end(), mt19937(t));
+  }
+  return keys;
+}
+
+template <typename F>
+double medir(int hilos, int por_hilo, F insertar) {
+  vector<vector<int>> keys = generar(hilos, por_hilo);
+  auto inicio = chrono::steady_clock::now();
+  vector<thread> pool;
+  for (int t = 0; t < hilos; t++) {
+    pool.emplace_back([&, t]() {
+      for (int k : keys[t]) insertar(k);
+    });
+  }
+  for (thread& th : pool) th.join();
+  double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+  return (double)hilos * por_hilo / segundos / 1e6;
+}
+
+int main(int argc, char** argv) {
+  int por_hilo = argc > 1 ? atoi(argv[1]) : 200000;
+  int M = argc > 2 ? atoi(argv[2]) : 64;
+  int max_hilos = max(1u, thread::hardware_concurrency());
+
+  cout << "inserciones por hilo: " << por_hilo << ", M = " << M << ", shards = " << SHARDS << endl;
+  cout << "hilos\tun mutex (Mops/s)\tpor rango (Mops/s)\tpor hash (Mops/s)" << endl;
+
+  for (int hilos = 1; hilos <= max_hilos * 2; hilos *= 2) {
+    int total = hilos * por_hilo;
+
+    BTree<int> unico(M);
+    mutex candado;
+    double base = medir(hilos, por_hilo, [&](int k) {
+      lock_guard<mutex> guard(candado);
+      unico.insert(k);
+    });
+
+    vector<int> limites;
+    for (int i = 1; i < SHARDS; i++) limites.push_back((long long)total * i / SHARDS);
+    ShardedBTree<int> por_rango(M, limites);
+    double rango = medir(hilos, por_hilo, [&](int k) { por_rango.insert(k); });
+
+    ShardedBTree<int> por_hash(M, SHARDS);
+    double hash = medir(hilos, por_hilo, [&](int k) { por_hash.insert(k); });
+
+    if (por_rango.size() != total || por_hash.size() != total || unico.size() != total) {
+      cerr << "error: cantidad de keys incorrecta" << endl;
+      return 1;
+    }
+    cout << hilos << "\t" << base << "\t\t\t" << rango << "\t\t\t" << hash << endl;
+  }
+  return 0;
+}
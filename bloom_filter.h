@@ -0,0 +1,104 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+// Filtro de Bloom por bloques: cada key cae en un solo bloque de 512 bits
+// (una linea de cache) y enciende un bit en cada una de sus 8 palabras, asi
+// que una consulta toca una sola linea. No admite borrados: el BTree lo
+// reconstruye cuando acumula demasiadas keys eliminadas
+template <typename TK>
+class BloomFilter {
+ private:
+  static const int PALABRAS = 8; // palabras de 64 bits por bloque
+
+  vector<uint64_t> bloques;
+  int capacidad;          // keys para las que se dimensiono
+  double bits_por_clave;
+
+  static uint64_t mezclar(TK key) {
+    // mezcla final de murmur3: std::hash de enteros suele ser la identidad
+    uint64_t h = hash<TK>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // bloque de la key y, en mascara, el bit de cada palabra
+  const uint64_t* ubicar(TK key, uint64_t mascara[PALABRAS]) const {
+    static const uint32_t SAL[PALABRAS] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                           0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+    uint64_t h = mezclar(key);
+    uint64_t num_bloques = bloques.size() / PALABRAS;
+    uint64_t bloque = ((h >> 32) * num_bloques) >> 32;
+    uint32_t bajo = (uint32_t)h;
+    for (int w = 0; w < PALABRAS; w++) {
+      mascara[w] = 1ULL << ((bajo * SAL[w]) >> 26);
+    }
+    return bloques.data() + bloque * PALABRAS;
+  }
+
+ public:
+  // estadisticas de las consultas hechas a traves del BTree
+  long long queries = 0;          // consultas al filtro
+  long long rejected = 0;         // descartadas por el filtro en O(1)
+  long long false_positives = 0;  // el filtro dejo pasar una key ausente
+
+  BloomFilter() : capacidad(0), bits_por_clave(0) {}
+
+  bool enabled() const {
+    return bits_por_clave > 0;
+  }
+
+  double bits_per_key() const {
+    return bits_por_clave;
+  }
+
+  int capacity() const {
+    return capacidad;
+  }
+
+  // deja el filtro vacio, dimensionado para _capacidad keys
+  void reset(int _capacidad, double _bits_por_clave) {
+    capacidad = _capacidad;
+    bits_por_clave = _bits_por_clave;
+    long long bits = (long long)(capacidad * bits_por_clave) + 1;
+    long long num_bloques = (bits + 64 * PALABRAS - 1) / (64 * PALABRAS);
+    bloques.assign(num_bloques * PALABRAS, 0);
+  }
+
+  void disable() {
+    bloques.clear();
+    capacidad = 0;
+    bits_por_clave = 0;
+  }
+
+  void add(TK key) {
+    uint64_t mascara[PALABRAS];
+    uint64_t* bloque = const_cast<uint64_t*>(ubicar(key, mascara));
+    for (int w = 0; w < PALABRAS; w++) bloque[w] |= mascara[w];
+  }
+
+  // false si key seguro no esta; true si puede estar
+  bool may_contain(TK key) const {
+    uint64_t mascara[PALABRAS];
+    const uint64_t* bloque = ubicar(key, mascara);
+    bool todos = true;
+    for (int w = 0; w < PALABRAS; w++) todos &= (bloque[w] & mascara[w]) != 0;
+    return todos;
+  }
+
+  // fraccion de las keys ausentes consultadas que el filtro no descarto
+  double false_positive_rate() const {
+    long long ausentes = rejected + false_positives;
+    return ausentes == 0 ? 0.0 : (double)false_positives / ausentes;
+  }
+};
+
+#endif
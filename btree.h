@@ -4,31 +4,54 @@
 #include <vector>
 #include <string>
 #include <queue>
+#include <utility>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <random>
+#include <thread>
 #include "node.h"
+#include "bloom_filter.h"
 
 using namespace std;
 
+// Resultado de verificar las invariantes de un BTree
+struct PropertyReport {
+  enum Violation { NONE, KEY_ORDER, SEPARATOR_BOUND, LEAF_DEPTH, NODE_BOUNDS, CHILD_POINTER, SIZE_MISMATCH, KEY_COUNT };
+
+  bool ok = true;
+  Violation violation = NONE;
+  string message;              // descripcion de la primera violacion encontrada
+  vector<int> path;            // indices de hijos desde la raiz hasta el nodo con la violacion
+  long long nodes_checked = 0;
+  long long paths_checked = 0; // solo en verify_sampled
+};
+
 template <typename TK>
 class BTree {
  private:
   Node<TK>* root;
   int M;  // grado u orden del arbol
-  int n; // total de elementos en el arbol 
+  int n; // total de elementos en el arbol (-1 si quedo pendiente tras un split o join)
+  static const int MIN_VERIFICACION_PARALELA = 1 << 16; // keys desde las que verify usa hilos
+  bool lazy; // modo de eliminacion perezosa (tombstones)
+  bool multiset; // cada key distinta se guarda una vez con su cantidad de ocurrencias
+  double umbral_tombstones; // proporcion de tombstones en una hoja que dispara su compactacion
+  vector<pair<Node<TK>*, int>> camino_tombstone; // (nodo, hijo) hasta la hoja; se reutiliza entre llamadas
+  long long version; // cambia con cada modificacion estructural; invalida los dedos
+  BloomFilter<TK> filtro; // filtro de membresia opcional para descartar busquedas fallidas
+  bool filtro_obsoleto;   // se reconstruye en la siguiente consulta
+  int eliminados_filtro;  // keys eliminadas desde la ultima reconstruccion
+
+  // key suelta junto con sus metadatos, para moverla entre nodos y arboles
+  struct Slot {
+    TK key;
+    bool dead;
+    int count;
+  };
 
   //helper functions
   private:
-  bool search(Node<TK>* node, TK key){
-    int i = 0;
-    while (i < node->count && key > node->keys[i]) i++;
-    if (key == node->keys[i]) {
-      return true;
-    }else if (!node -> leaf) {
-      return search(node->children[i], key);
-    } else {
-      return false;
-    }
-  }
-
   vector<TK> range_search(Node<TK>* node, TK begin, TK end){
     vector<TK> output;
     if (node == nullptr) return output;
@@ -42,9 +65,9 @@ class BTree {
         output.insert(output.end(), other.begin(), other.end());
       }
 
-      //insertamos el valor
-      if (k >= begin && k <= end) {
-        output.push_back(node->keys[i]);
+      //insertamos el valor (salvo que sea tombstone)
+      if (k >= begin && k <= end && !node->dead[i]) {
+        output.insert(output.end(), ocurrencias(node, i), node->keys[i]);
       }
     }
 
@@ -68,7 +91,9 @@ class BTree {
       if (!node->leaf && node->children[i] != nullptr){
         output += toString(node->children[i], sep, depth + 1);
       }
-      output += to_string(node->keys[i]) + sep;
+      if (!node->dead[i]) {
+        for (int c = 0; c < ocurrencias(node, i); c++) output += to_string(node->keys[i]) + sep;
+      }
     }
 
     if (!node->leaf && node->children[node->count] != nullptr){
@@ -79,108 +104,144 @@ class BTree {
   }
 
   //funciones auxiliares para verificar las propiedades del arbol
-  bool verificar_keys_ordenadas(Node<TK>* nodo) {
-    if (nodo == nullptr) return true;
-    
-    for (int i = 0; i < nodo->count - 1; i++) {
-      if (nodo->keys[i] >= nodo->keys[i + 1]) {
-        return false;
-      }
+
+  // nodo pendiente de verificar junto con los separadores que lo acotan
+  struct TareaVerificacion {
+    Node<TK>* nodo;
+    int nivel;
+    const TK* lo;
+    const TK* hi;
+    vector<int> camino;
+  };
+
+  // verifica localmente un nodo: nivel de las hojas, limites de keys, orden
+  // de las keys, cotas del separador del padre y punteros a hijos
+  bool verificar_nodo(Node<TK>* nodo, int nivel, int altura_hojas,
+                      const TK* lo, const TK* hi, PropertyReport& r) {
+    r.nodes_checked++;
+    auto falla = [&](PropertyReport::Violation v, const string& msg) {
+      r.ok = false;
+      r.violation = v;
+      r.message = msg;
+      return false;
+    };
+
+    if (nodo->leaf != (nivel == altura_hojas)) {
+      return falla(PropertyReport::LEAF_DEPTH, nodo->leaf
+          ? "hoja en el nivel " + to_string(nivel) + ", se esperaba " + to_string(altura_hojas)
+          : "nodo interno en el nivel de las hojas " + to_string(nivel));
     }
-    
-    if (!nodo->leaf) {
-      for (int i = 0; i <= nodo->count; i++) {
-        if (!verificar_keys_ordenadas(nodo->children[i])) {
-          return false;
-        }
+
+    // la raiz tiene al menos 1 key; el resto, entre ⌈M/2⌉ - 1 y M - 1
+    int min_keys = nivel == 0 ? 1 : (M + 1) / 2 - 1;
+    int max_keys = M - 1;
+    if (nodo->count < min_keys || nodo->count > max_keys) {
+      return falla(PropertyReport::NODE_BOUNDS, "el nodo tiene " + to_string(nodo->count) +
+          " keys, se esperaba entre " + to_string(min_keys) + " y " + to_string(max_keys));
+    }
+
+    for (int i = 0; i < nodo->count - 1; i++) {
+      if (!(nodo->keys[i] < nodo->keys[i + 1])) {
+        return falla(PropertyReport::KEY_ORDER, "keys desordenadas en las posiciones " +
+            to_string(i) + " y " + to_string(i + 1));
       }
     }
-    
-    return true;
-  }
 
-  bool verificar_altura_hojas(Node<TK>* nodo) {
-    if (nodo == nullptr) return true;
-        int altura_esperada = 0;
-    Node<TK>* temp = nodo;
-    while (!temp->leaf) {
-      temp = temp->children[0];
-      altura_esperada++;
+    if (lo != nullptr && !(*lo < nodo->keys[0])) {
+      return falla(PropertyReport::SEPARATOR_BOUND, "la primera key no es mayor que el separador izquierdo del padre");
     }
-    
-    return verificar_todas_hojas_mismo_nivel(nodo, 0, altura_esperada);
-  }
-  
-  bool verificar_todas_hojas_mismo_nivel(Node<TK>* nodo, int nivel_actual, int altura_esperada) {
-    if (nodo == nullptr) return true;
-    
-    if (nodo->leaf) {
-      return nivel_actual == altura_esperada;
+    if (hi != nullptr && !(nodo->keys[nodo->count - 1] < *hi)) {
+      return falla(PropertyReport::SEPARATOR_BOUND, "la ultima key no es menor que el separador derecho del padre");
     }
-    
-    for (int i = 0; i <= nodo->count; i++) {
-      if (!verificar_todas_hojas_mismo_nivel(nodo->children[i], nivel_actual + 1, altura_esperada)) {
-        return false;
+
+    for (int i = 0; nodo->counts != nullptr && i < nodo->count; i++) {
+      if (!nodo->dead[i] && nodo->counts[i] < 1) {
+        return falla(PropertyReport::KEY_COUNT, "la key en la posicion " + to_string(i) +
+            " tiene " + to_string(nodo->counts[i]) + " ocurrencias");
+      }
+    }
+
+    // un nodo interno tiene exactamente count + 1 hijos; el resto en nullptr
+    for (int i = 0; i <= M; i++) {
+      bool esperado = !nodo->leaf && i <= nodo->count;
+      if ((nodo->children[i] != nullptr) != esperado) {
+        return falla(PropertyReport::CHILD_POINTER, "puntero al hijo " + to_string(i) +
+            (esperado ? " nulo" : " deberia ser nulo"));
       }
     }
-    
     return true;
   }
-  
-  bool verificar_limites_nodos(Node<TK>* nodo, bool es_raiz) {
-    if (nodo == nullptr) return true;
 
-    //Calculo de los limites en base a M
-    int min_keys = (M + 1) / 2 - 1;
-    int max_keys = M - 1;
-    int min_children = (M + 1) / 2;
-    int max_children = M;
-    
-    if (!es_raiz) {
-      // verificar límites de keys en nodos internos que no son la raiz
-      if (nodo->count < min_keys || nodo->count > max_keys) {
-        return false;
-      }
-      
-      // verificar límites de children en nodos internos que no son la raiz
-      if (!nodo->leaf) {
-        int num_children = nodo->count + 1;
-        if (num_children < min_children || num_children > max_children) {
-          return false;
-        }
-      }
-    } else {
-      // verificar que la raiz tiene al menos 1 key y máximo M-1 keys
-      if (nodo->count < 1 || nodo->count > max_keys) {
-        return false;
-      }
-      
-      // verificar que la raiz interna tenga al menos 2 hijos y máximo M hijos
-      if (!nodo->leaf) {
-        int num_children = nodo->count + 1;
-        if (num_children < 2 || num_children > max_children) {
-          return false;
-        }
-      }
+  int vivos_en_nodo(Node<TK>* nodo) {
+    int vivos = 0;
+    for (int i = 0; i < nodo->count; i++) {
+      if (!nodo->dead[i]) vivos += ocurrencias(nodo, i);
     }
-    
-    // Recursivamente verificar todos los hijos
+    return vivos;
+  }
+
+  // cota inferior de keys de un arbol de altura h: la raiz tiene al menos 2
+  // hijos y cada nodo interno al menos ⌈M/2⌉, asi que hay 2⌈M/2⌉^(h-1) hojas
+  // como minimo. Se satura en MIN_VERIFICACION_PARALELA
+  long long minimo_keys(int h) {
+    if (h <= 0) return 1;
+    long long hojas = 2;
+    for (int l = 1; l < h && hojas < MIN_VERIFICACION_PARALELA; l++) hojas *= (M + 1) / 2;
+    return min<long long>(hojas * ((M + 1) / 2 - 1) + hojas - 1, MIN_VERIFICACION_PARALELA);
+  }
+
+  // verifica todo el subarbol en una sola pasada. Retorna sus keys vivas, o -1
+  // si encontro una violacion (r.path queda apuntando al nodo culpable)
+  long long verificar_subarbol(Node<TK>* nodo, int nivel, int altura_hojas,
+                               const TK* lo, const TK* hi, PropertyReport& r) {
+    if (!verificar_nodo(nodo, nivel, altura_hojas, lo, hi, r)) return -1;
+
+    long long vivos = vivos_en_nodo(nodo);
     if (!nodo->leaf) {
       for (int i = 0; i <= nodo->count; i++) {
-        if (!verificar_limites_nodos(nodo->children[i], false)) {
-          return false;
-        }
+        r.path.push_back(i);
+        long long c = verificar_subarbol(nodo->children[i], nivel + 1, altura_hojas,
+                                         i > 0 ? &nodo->keys[i - 1] : lo,
+                                         i < nodo->count ? &nodo->keys[i] : hi, r);
+        if (c < 0) return -1;
+        r.path.pop_back();
+        vivos += c;
       }
     }
-    
-    return true;
+    return vivos;
   }
 
-  TK get_successor(Node<TK>* node) {
+  // hoja que contiene el sucesor (su key en la posicion 0)
+  Node<TK>* get_successor(Node<TK>* node) {
     while (!node->leaf) {
       node = node->children[0];
     }
-    return node->keys[0];
+    return node;
+  }
+
+  // copia la key src->keys[j] a dst->keys[i] junto con su marca de tombstone
+  // y su contador
+  void mover_key(Node<TK>* dst, int i, Node<TK>* src, int j) {
+    dst->keys[i] = src->keys[j];
+    dst->dead[i] = src->dead[j];
+    if (dst->counts != nullptr) dst->counts[i] = src->counts[j];
+  }
+
+  // ocurrencias de la key i del nodo (1 fuera del modo multiset)
+  int ocurrencias(Node<TK>* node, int i) const {
+    return node->counts != nullptr ? node->counts[i] : 1;
+  }
+
+  // nodo que contiene key y su posicion en i, o nullptr si no esta
+  Node<TK>* nodo_de(TK key, int& i) {
+    Node<TK>* node = root;
+    while (node != nullptr) {
+      i = 0;
+      while (i < node->count && node->keys[i] < key) i++;
+      if (i < node->count && node->keys[i] == key) return node;
+      node = node->leaf ? nullptr : node->children[i];
+    }
+    return nullptr;
   }
   
   // tomar una key del hermano izquierdo
@@ -190,7 +251,7 @@ class BTree {
     
     // Desplazar todas las keys del hijo una pos a la der
     for (int i = hijo->count; i > 0; i--) {
-      hijo->keys[i] = hijo->keys[i - 1];
+      mover_key(hijo, i, hijo, i - 1);
     }
     
     // desplazar hijos si no es hoja
@@ -201,11 +262,11 @@ class BTree {
     }
 
     // La key del padre baja al hijo
-    hijo->keys[0] = padre->keys[idx_hijo - 1];
+    mover_key(hijo, 0, padre, idx_hijo - 1);
     hijo->count++;
     
     // La ultima key del hermano sube al padre
-    padre->keys[idx_hijo - 1] = hermano_izquierdo->keys[hermano_izquierdo->count - 1];
+    mover_key(padre, idx_hijo - 1, hermano_izquierdo, hermano_izquierdo->count - 1);
     
     if (!hijo->leaf) {
       hijo->children[0] = hermano_izquierdo->children[hermano_izquierdo->count];
@@ -219,17 +280,17 @@ class BTree {
     Node<TK>* hijo = padre->children[idx_hijo];
     Node<TK>* hermano_derecho = padre->children[idx_hijo + 1];
     
-    hijo->keys[hijo->count] = padre->keys[idx_hijo];
+    mover_key(hijo, hijo->count, padre, idx_hijo);
     hijo->count++;
     
-    padre->keys[idx_hijo] = hermano_derecho->keys[0];
+    mover_key(padre, idx_hijo, hermano_derecho, 0);
     
     if (!hijo->leaf) {
       hijo->children[hijo->count] = hermano_derecho->children[0];
     }
     
     for (int i = 0; i < hermano_derecho->count - 1; i++) {
-      hermano_derecho->keys[i] = hermano_derecho->keys[i + 1];
+      mover_key(hermano_derecho, i, hermano_derecho, i + 1);
     }
     
     if (!hermano_derecho->leaf) {
@@ -248,11 +309,11 @@ class BTree {
     
     int pos_inicial = nodo_izq->count;
 
-    nodo_izq->keys[pos_inicial++] = padre->keys[idx_hijo - 1];
+    mover_key(nodo_izq, pos_inicial++, padre, idx_hijo - 1);
     
     int j = 0;
     while (j < nodo_actual->count) {
-      nodo_izq->keys[pos_inicial + j] = nodo_actual->keys[j];
+      mover_key(nodo_izq, pos_inicial + j, nodo_actual, j);
       j++;
     }
     
@@ -268,7 +329,7 @@ class BTree {
     
     int pos = idx_hijo - 1;
     while (pos < padre->count - 1) {
-      padre->keys[pos] = padre->keys[pos + 1];
+      mover_key(padre, pos, padre, pos + 1);
       pos++;
     }
     
@@ -292,12 +353,12 @@ class BTree {
     int pos_base = nodo_izq->count;
     
     // insertamos la key del padre
-    nodo_izq->keys[pos_base] = padre->keys[idx_hijo];
+    mover_key(nodo_izq, pos_base, padre, idx_hijo);
     
     // copiamos las keys del hermano derecho
     int offset = pos_base + 1;
     for (int k = 0; k < nodo_der->count; k++) {
-      nodo_izq->keys[offset + k] = nodo_der->keys[k];
+      mover_key(nodo_izq, offset + k, nodo_der, k);
     }
     
     nodo_izq->count = offset + nodo_der->count;
@@ -315,7 +376,7 @@ class BTree {
     // eliminamos la key del padre desplazandonos hacia la izquierda
     int idx_key = idx_hijo;
     while (idx_key + 1 < padre->count) {
-      padre->keys[idx_key] = padre->keys[idx_key + 1];
+      mover_key(padre, idx_key, padre, idx_key + 1);
       idx_key++;
     }
     
@@ -330,7 +391,309 @@ class BTree {
     delete nodo_der;
   }
   
+  Slot sacar(Node<TK>* node, int i) {
+    return Slot{node->keys[i], node->dead[i], ocurrencias(node, i)};
+  }
+
+  void poner(Node<TK>* node, int i, const Slot& slot) {
+    node->keys[i] = slot.key;
+    node->dead[i] = slot.dead;
+    if (node->counts != nullptr) node->counts[i] = slot.count;
+  }
+
+  // divide un nodo con M keys. La mitad derecha pasa al nodo retornado y la
+  // key promovida queda en node->keys[node->count]
+  Node<TK>* partir(Node<TK>* node) {
+    version++;
+    Node<TK>* newSibling = new Node<TK>(M, multiset);
+    newSibling->leaf = node->leaf;
+
+    int mid = M / 2;
+    newSibling->count = node->count - mid - 1;
+    for (int j = 0; j < newSibling->count; j++) {
+      mover_key(newSibling, j, node, mid + 1 + j);
+    }
+    if (!node->leaf) {
+      for (int j = 0; j <= newSibling->count; j++) {
+        newSibling->children[j] = node->children[mid + 1 + j];
+        node->children[mid + 1 + j] = nullptr;
+      }
+    }
+
+    node->count = mid;
+    return newSibling;
+  }
+
+  // altura del subarbol: 0 para una hoja, -1 para un subarbol vacio
+  int altura(Node<TK>* node) {
+    int h = -1;
+    while (node != nullptr) {
+      h++;
+      node = node->leaf ? nullptr : node->children[0];
+    }
+    return h;
+  }
+
+  // repara un hijo con menos del minimo de keys pidiendo prestado las veces
+  // que haga falta, o fusionandolo con un hermano
+  void reparar_hijo(Node<TK>* padre, int idx_hijo) {
+    int min_claves = (M + 1) / 2 - 1;
+    while (padre->children[idx_hijo]->count < min_claves) {
+      bool izq = idx_hijo > 0 && padre->children[idx_hijo - 1]->count > min_claves;
+      bool der = idx_hijo < padre->count && padre->children[idx_hijo + 1]->count > min_claves;
+      fix_children_remove(padre, idx_hijo);
+      if (!izq && !der) return; // hubo fusion
+    }
+  }
+
+  // une b como ultimo hijo de un nodo del borde derecho de x, con sep como
+  // separador. hb < hx. Retorna true si x hizo split (ver partir)
+  bool unir_derecha(Node<TK>* x, int hx, const Slot& sep, Node<TK>* b, int hb, Node<TK>*& nuevo) {
+    if (hx == hb + 1) {
+      poner(x, x->count, sep);
+      x->children[x->count + 1] = b;
+      x->count++;
+      if (!x->leaf) reparar_hijo(x, x->count);
+    } else {
+      Node<TK>* hijo = x->children[x->count];
+      Node<TK>* hermano = nullptr;
+      if (unir_derecha(hijo, hx - 1, sep, b, hb, hermano)) {
+        mover_key(x, x->count, hijo, hijo->count);
+        x->children[x->count + 1] = hermano;
+        x->count++;
+      }
+    }
+    if (x->count == M) {
+      nuevo = partir(x);
+      return true;
+    }
+    return false;
+  }
+
+  // simetrico a unir_derecha: a entra como primer hijo del borde izquierdo de x
+  bool unir_izquierda(Node<TK>* x, int hx, Node<TK>* a, int ha, const Slot& sep, Node<TK>*& nuevo) {
+    if (hx == ha + 1) {
+      for (int j = x->count; j > 0; j--) {
+        mover_key(x, j, x, j - 1);
+        x->children[j + 1] = x->children[j];
+      }
+      x->children[1] = x->children[0];
+      poner(x, 0, sep);
+      x->children[0] = a;
+      x->count++;
+      if (!x->leaf) reparar_hijo(x, 0);
+    } else {
+      Node<TK>* hijo = x->children[0];
+      Node<TK>* hermano = nullptr;
+      if (unir_izquierda(hijo, hx - 1, a, ha, sep, hermano)) {
+        for (int j = x->count; j > 0; j--) {
+          mover_key(x, j, x, j - 1);
+          x->children[j + 1] = x->children[j];
+        }
+        mover_key(x, 0, hijo, hijo->count);
+        x->children[1] = hermano;
+        x->count++;
+      }
+    }
+    if (x->count == M) {
+      nuevo = partir(x);
+      return true;
+    }
+    return false;
+  }
+
+  // concatena los arboles a (altura ha) y b (altura hb) con sep en medio;
+  // todas las keys de a < sep < todas las de b. Costo O(|ha - hb| + 1)
+  Node<TK>* unir(Node<TK>* a, int ha, const Slot& sep, Node<TK>* b, int hb, int& h) {
+    if (ha == hb) {
+      Node<TK>* r = new Node<TK>(M, multiset);
+      poner(r, 0, sep);
+      r->count = 1;
+      h = ha + 1;
+      if (a == nullptr) return r;
+
+      r->leaf = false;
+      r->children[0] = a;
+      r->children[1] = b;
+      reparar_hijo(r, 0);
+      if (r->count > 0) reparar_hijo(r, 1);
+      if (r->count == 0) {
+        // a y b se fusionaron en un solo nodo
+        Node<TK>* unico = r->children[0];
+        r->children[0] = nullptr;
+        delete r;
+        h = ha;
+        return unico;
+      }
+      return r;
+    }
+
+    Node<TK>* alto = ha > hb ? a : b;
+    Node<TK>* hermano = nullptr;
+    bool split = ha > hb ? unir_derecha(a, ha, sep, b, hb, hermano)
+                         : unir_izquierda(b, hb, a, ha, sep, hermano);
+    h = max(ha, hb);
+    if (!split) return alto;
+
+    Node<TK>* r = new Node<TK>(M, multiset);
+    r->leaf = false;
+    r->count = 1;
+    mover_key(r, 0, alto, alto->count);
+    r->children[0] = alto;
+    r->children[1] = hermano;
+    h++;
+    return r;
+  }
+
+  // nodo con las keys [desde, hasta) de x y sus hijos correspondientes.
+  // Si no le queda ninguna key, el fragmento es su unico hijo
+  Node<TK>* fragmento(Node<TK>* x, int hx, int desde, int hasta, int& h) {
+    if (desde == hasta) {
+      h = hx - 1;
+      return x->children[desde];
+    }
+    Node<TK>* f = new Node<TK>(M, multiset);
+    f->leaf = false;
+    f->count = hasta - desde;
+    for (int j = desde; j < hasta; j++) mover_key(f, j - desde, x, j);
+    for (int j = desde; j <= hasta; j++) f->children[j - desde] = x->children[j];
+    h = hx;
+    return f;
+  }
+
+  // parte el subarbol x en L (keys < key, o <= key si incluir_igual) y R
+  // (el resto). Consume x; L y R son arboles validos con raiz relajada
+  void dividir(Node<TK>* x, int hx, TK key, bool incluir_igual,
+               Node<TK>*& L, int& hL, Node<TK>*& R, int& hR) {
+    if (x == nullptr) {
+      L = R = nullptr;
+      hL = hR = -1;
+      return;
+    }
+    int i = 0;
+    while (i < x->count && (x->keys[i] < key || (incluir_igual && x->keys[i] == key))) i++;
+
+    if (x->leaf) {
+      Node<TK>* der = new Node<TK>(M, multiset);
+      der->count = x->count - i;
+      for (int j = i; j < x->count; j++) mover_key(der, j - i, x, j);
+      x->count = i;
+      L = x; hL = 0;
+      R = der; hR = 0;
+      if (L->count == 0) { delete L; L = nullptr; hL = -1; }
+      if (R->count == 0) { delete R; R = nullptr; hR = -1; }
+      return;
+    }
+
+    Node<TK>* cl; Node<TK>* cr;
+    int hcl, hcr;
+    dividir(x->children[i], hx - 1, key, incluir_igual, cl, hcl, cr, hcr);
+
+    R = cr; hR = hcr;
+    if (i < x->count) {
+      int hf;
+      Node<TK>* f = fragmento(x, hx, i + 1, x->count, hf);
+      R = unir(cr, hcr, sacar(x, i), f, hf, hR);
+    }
+
+    L = cl; hL = hcl;
+    if (i > 0) {
+      int hf;
+      Slot sep = sacar(x, i - 1);
+      Node<TK>* f = fragmento(x, hx, 0, i - 1, hf);
+      L = unir(f, hf, sep, cl, hcl, hL);
+    }
+    delete x; // sus hijos ya pertenecen a los fragmentos
+  }
+
+  // se dimensiona para el doble de las keys actuales: deja margen para crecer
+  // antes de la siguiente reconstruccion (ver al_insertar)
+  void reconstruir_filtro() {
+    asegurar_n();
+    filtro.reset(max(2 * n, 64), filtro.bits_per_key());
+    for (iterator it = begin(); it != end(); ++it) filtro.add(*it);
+    filtro_obsoleto = false;
+    eliminados_filtro = 0;
+  }
+
+  // true si el filtro asegura que key no esta
+  bool filtro_descarta(TK key) {
+    if (!filtro.enabled()) return false;
+    if (filtro_obsoleto) reconstruir_filtro();
+    filtro.queries++;
+    if (filtro.may_contain(key)) return false;
+    filtro.rejected++;
+    return true;
+  }
+
+  void al_insertar(TK key) {
+    if (!filtro.enabled() || filtro_obsoleto) return;
+    filtro.add(key);
+    // pasada su capacidad la tasa de falsos positivos crece: se redimensiona
+    if (n > filtro.capacity()) filtro_obsoleto = true;
+  }
+
+  // el filtro no admite borrados: las keys eliminadas solo lo degradan y
+  // cuando llegan a la mitad de las vivas se reconstruye
+  void al_eliminar(int cantidad) {
+    if (!filtro.enabled() || cantidad <= 0) return;
+    eliminados_filtro += cantidad;
+    if (eliminados_filtro > n / 2) filtro_obsoleto = true;
+  }
+
+  // recuenta n si quedo pendiente tras un split o join
+  void asegurar_n() {
+    if (n < 0) n = contar_vivos(root);
+  }
+
+  // actualiza n si se conoce; si esta pendiente el recuento ya incluira el cambio
+  void sumar_n(int delta) {
+    if (n >= 0) n += delta;
+  }
+
+  // arbol nuevo del mismo orden construido en O(n) a partir de keys ordenadas.
+  // Con conteos (paralelo a keys) el resultado es un multiset
+  BTree desde_ordenado(const vector<TK>& keys, const vector<int>* conteos = nullptr) {
+    BTree resultado(M, conteos != nullptr);
+    resultado.root = resultado.construir_ordenado(keys, conteos);
+    resultado.n = keys.size();
+    if (conteos != nullptr) {
+      resultado.n = 0;
+      for (int c : *conteos) resultado.n += c;
+    }
+    return resultado;
+  }
+
+  // union de multisets: las ocurrencias de las keys comunes se suman
+  BTree suma(BTree& other){
+    vector<TK> out;
+    vector<int> conteos;
+    iterator a = begin(), b = other.begin();
+    while (a != end() || b != other.end()) {
+      bool de_a = b == other.end() || (a != end() && !(*b < *a));
+      bool de_b = a == end() || (b != other.end() && !(*a < *b));
+      out.push_back(de_a ? *a : *b);
+      conteos.push_back((de_a ? a.count() : 0) + (de_b ? b.count() : 0));
+      if (de_a) ++a;
+      if (de_b) ++b;
+    }
+    return desde_ordenado(out, &conteos);
+  }
+
+  // cantidad de keys vivas del subarbol
+  int contar_vivos(Node<TK>* node) {
+    if (node == nullptr) return 0;
+    int total = 0;
+    for (int i = 0; i < node->count; i++) {
+      if (!node->dead[i]) total += ocurrencias(node, i);
+      if (!node->leaf) total += contar_vivos(node->children[i]);
+    }
+    if (!node->leaf) total += contar_vivos(node->children[node->count]);
+    return total;
+  }
+
   void fix_children_remove(Node<TK>* padre, int idx_hijo) {
+    version++;
     int min_claves = (M + 1) / 2 - 1;
     
     // Intentar pedir prestado del hermano izquierdo
@@ -353,7 +716,158 @@ class BTree {
     }
   }
 
-  bool remove_recursion(Node<TK>* node, TK key) {
+  // elimina la key del arbol con rebalanceo; no modifica n. En vivos deja
+  // cuantas ocurrencias vivas tenia
+  bool eliminar_fisico(TK key, int* vivos = nullptr) {
+    version++;
+    bool found = remove_recursion(root, key, vivos);
+    if (found) ajustar_raiz();
+    return found;
+  }
+
+  void ajustar_raiz() {
+    //si la raiz quedo vacia, pero este tiene un hijop, el hijo se convierte en la nueva raiz
+    if (root->count == 0 && !root->leaf) {
+      Node<TK>* old_rt = root;
+      root = root->children[0];
+      old_rt->children[0] = nullptr;
+      delete old_rt;
+    }
+
+    // si el arbol esta totalmente vacio, eliminar la raiz
+    if (root && root->count == 0 && root->leaf) {
+      delete root;
+      root = nullptr;
+    }
+  }
+
+  // marca la key como tombstone en O(log n); retorna false si no estaba viva.
+  // Si la hoja supera el umbral de tombstones se compacta (ver compactar_hoja).
+  // Los tombstones de nodos internos esperan a purge() o a bajar a una hoja
+  // en una fusion
+  bool marcar_tombstone(TK key) {
+    camino_tombstone.clear();
+    Node<TK>* node = root;
+    int i = 0;
+    while (node != nullptr) {
+      i = 0;
+      while (i < node->count && node->keys[i] < key) i++;
+      if (i < node->count && node->keys[i] == key) break;
+      if (node->leaf) return false;
+      camino_tombstone.push_back({node, i});
+      node = node->children[i];
+    }
+    if (node == nullptr || node->dead[i]) return false;
+    node->dead[i] = true;
+    sumar_n(-ocurrencias(node, i));
+
+    if (!node->leaf) return true;
+    int muertos = 0;
+    for (int j = 0; j < node->count; j++) muertos += node->dead[j];
+    if (muertos > umbral_tombstones * node->count) compactar_hoja(node);
+    return true;
+  }
+
+  // saca en una sola pasada las keys muertas de la hoja al final de
+  // camino_tombstone y repara el underflow una vez por nivel, subiendo por
+  // ese camino solo mientras algun nodo quede por debajo del minimo
+  void compactar_hoja(Node<TK>* hoja) {
+    version++;
+    int vivas = 0;
+    for (int j = 0; j < hoja->count; j++) {
+      if (!hoja->dead[j]) mover_key(hoja, vivas++, hoja, j);
+    }
+    hoja->count = vivas;
+
+    int min_keys = (M + 1) / 2 - 1;
+    for (int l = (int)camino_tombstone.size() - 1; l >= 0; l--) {
+      Node<TK>* padre = camino_tombstone[l].first;
+      int idx = camino_tombstone[l].second;
+      if (padre->children[idx]->count >= min_keys) break;
+      reparar_hijo(padre, idx);
+    }
+    ajustar_raiz();
+  }
+
+  // agrega en orden las keys vivas (y sus ocurrencias en conteos); retorna la
+  // cantidad de tombstones vistos
+  int recolectar_vivos(Node<TK>* node, vector<TK>& out, vector<int>& conteos) {
+    if (node == nullptr) return 0;
+    int muertos = 0;
+    for (int i = 0; i < node->count; i++) {
+      if (!node->leaf) muertos += recolectar_vivos(node->children[i], out, conteos);
+      if (node->dead[i]) {
+        muertos++;
+      } else {
+        out.push_back(node->keys[i]);
+        conteos.push_back(ocurrencias(node, i));
+      }
+    }
+    if (!node->leaf) muertos += recolectar_vivos(node->children[node->count], out, conteos);
+    return muertos;
+  }
+
+  // construye un subarbol valido de abajo hacia arriba a partir de keys
+  // ordenadas en O(n). Cada nivel se reparte en ceil((k+1)/M) nodos lo mas
+  // parejos posible, lo que garantiza el minimo de keys por nodo. En modo
+  // multiset conteos trae las ocurrencias de cada key (1 si es nullptr)
+  Node<TK>* construir_ordenado(const vector<TK>& elements, const vector<int>* conteos = nullptr) {
+    if (elements.empty()) return nullptr;
+    vector<TK> keys = elements;
+    vector<int> cuentas;
+    if (multiset) cuentas = conteos != nullptr ? *conteos : vector<int>(keys.size(), 1);
+    vector<Node<TK>*> hijos; // nodos del nivel inferior (vacio para las hojas)
+
+    while (true) {
+      int total = keys.size();
+      int nodos = (total + M) / M;
+      int en_nodos = total - (nodos - 1);
+      vector<Node<TK>*> nivel;
+      vector<TK> separadores;
+      vector<int> cuentas_separadores;
+      int pos = 0, h = 0;
+
+      for (int j = 0; j < nodos; j++) {
+        Node<TK>* nodo = new Node<TK>(M, multiset);
+        nodo->leaf = hijos.empty();
+        nodo->count = en_nodos / nodos + (j < en_nodos % nodos ? 1 : 0);
+        for (int t = 0; t < nodo->count; t++) {
+          if (!nodo->leaf) nodo->children[t] = hijos[h++];
+          if (multiset) nodo->counts[t] = cuentas[pos];
+          nodo->keys[t] = keys[pos++];
+        }
+        if (!nodo->leaf) nodo->children[nodo->count] = hijos[h++];
+        nivel.push_back(nodo);
+        if (j + 1 < nodos) {
+          if (multiset) cuentas_separadores.push_back(cuentas[pos]);
+          separadores.push_back(keys[pos++]);
+        }
+      }
+
+      if (nodos == 1) return nivel[0];
+      keys.swap(separadores);
+      cuentas.swap(cuentas_separadores);
+      hijos.swap(nivel);
+    }
+  }
+
+  // primera (o ultima) key viva en inorden del subarbol
+  bool extremo_vivo(Node<TK>* node, bool maximo, TK& out) {
+    if (node == nullptr) return false;
+    for (int t = 0; t <= node->count; t++) {
+      int c = maximo ? node->count - t : t;
+      if (!node->leaf && extremo_vivo(node->children[c], maximo, out)) return true;
+      if (t == node->count) break;
+      int i = maximo ? node->count - 1 - t : t;
+      if (!node->dead[i]) {
+        out = node->keys[i];
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool remove_recursion(Node<TK>* node, TK key, int* vivos = nullptr) {
     // Caso base: nodo nulo
     if (!node) return false;
     
@@ -368,15 +882,21 @@ class BTree {
     }
     // ver si la key esta en este nodo
     bool found_in_node = (idx < node->count && node->keys[idx] == key);
+    if (found_in_node && vivos != nullptr) *vivos = node->dead[idx] ? 0 : ocurrencias(node, idx);
     
     // 3: Key encontrada en nodo interno no hoja
     // Se reemplaza la key con su sucesor y luego eliminar recursivamente el sucesor
     if (found_in_node && !node->leaf) {
-      TK sucesor = get_successor(node->children[idx + 1]);
+      Node<TK>* hoja_sucesor = get_successor(node->children[idx + 1]);
+      TK sucesor = hoja_sucesor->keys[0];
       
-      node->keys[idx] = sucesor;
+      mover_key(node, idx, hoja_sucesor, 0);
       
-      return remove_recursion(node->children[idx + 1], sucesor);
+      remove_recursion(node->children[idx + 1], sucesor);
+      if (node->children[idx + 1]->count < min_keys) {
+        fix_children_remove(node, idx + 1);
+      }
+      return true;
     }
     
     // 0: Key en nodo hoja 
@@ -386,7 +906,7 @@ class BTree {
       
       // Eliminamos la key desplazando todas las keys siguientes una posición a la izquierda
       for (int i = idx; i < node->count - 1; i++) {
-        node->keys[i] = node->keys[i + 1];
+        mover_key(node, i, node, i + 1);
       }
       node->count--;
       return true;
@@ -395,7 +915,7 @@ class BTree {
     // CASO 1 y 2: Key no esta en este nodo, se desciende al hijo apropiado
     Node<TK>* hijo = node->children[idx];
     
-    bool encontrado = remove_recursion(hijo, key);
+    bool encontrado = remove_recursion(hijo, key, vivos);
     
     if (!encontrado) return false;
     
@@ -408,26 +928,411 @@ class BTree {
   }
 
  public:
-  BTree(int _M) : root(nullptr), M(_M), n(0) {}
+  // iterador inorden sobre las keys vivas (salta los tombstones). En modo
+  // multiset recorre las keys distintas; count() da sus ocurrencias. Tambien
+  // sirve de dedo (finger) para insert/find con hint. Cualquier modificacion
+  // estructural del arbol lo invalida
+  class iterator {
+    friend class BTree;
+
+    // en el tope, i es la key actual; en los niveles de abajo, i es el hijo
+    // por el que se bajo y keys[i] la key que sigue al terminarlo. lo y hi son
+    // los niveles de los ancestros cuyos separadores acotan el rango del nodo
+    // (-1 si no hay cota de ese lado)
+    struct Paso {
+      Node<TK>* nodo;
+      int i;
+      int lo;
+      int hi;
+    };
+    vector<Paso> camino;
+    const BTree* arbol = nullptr; // arbol y version en que se construyo el camino
+    long long version = 0;
+
+    void empujar(Node<TK>* nodo, int i) {
+      Paso p = {nodo, i, -1, -1};
+      if (!camino.empty()) {
+        int padre = camino.size() - 1;
+        const Paso& q = camino[padre];
+        p.lo = q.i > 0 ? padre : q.lo;
+        p.hi = q.i < q.nodo->count ? padre : q.hi;
+      }
+      camino.push_back(p);
+    }
+
+    // indica si key cae estrictamente dentro del rango del nodo del nivel l
+    bool contiene(int l, TK key) const {
+      const Paso& p = camino[l];
+      if (p.lo >= 0 && !(camino[p.lo].nodo->keys[camino[p.lo].i - 1] < key)) return false;
+      if (p.hi >= 0 && !(key < camino[p.hi].nodo->keys[camino[p.hi].i])) return false;
+      return true;
+    }
+
+    // nivel del camino desde el que conviene partir para key: el tope o su
+    // padre si su rango contiene a key; -1 si hay que partir desde la raiz
+    int nivel_para(TK key) const {
+      for (int l = (int)camino.size() - 1; l >= 0 && l >= (int)camino.size() - 2; l--) {
+        if (contiene(l, key)) return l;
+      }
+      return -1;
+    }
+
+    // deja el camino hasta el nivel desde el que se parte y retorna su nodo
+    // (ya fuera del camino), o nullptr si hay que empezar desde la raiz
+    Node<TK>* subir_hasta(TK key) {
+      int l = nivel_para(key);
+      if (l < 0) {
+        camino.clear();
+        return nullptr;
+      }
+      Node<TK>* node = camino[l].nodo;
+      camino.resize(l);
+      return node;
+    }
+
+    // baja desde node hasta la primera key >= key de su subarbol
+    void bajar(Node<TK>* node, TK key) {
+      while (node != nullptr) {
+        int i = 0;
+        while (i < node->count && node->keys[i] < key) i++;
+        empujar(node, i);
+        if ((i < node->count && node->keys[i] == key) || node->leaf) break;
+        node = node->children[i];
+      }
+      normalizar();
+    }
+
+    void bajar_minimo(Node<TK>* node) {
+      while (node != nullptr) {
+        empujar(node, 0);
+        node = node->leaf ? nullptr : node->children[0];
+      }
+    }
+
+    // sube mientras el tope ya no tenga keys por recorrer
+    void normalizar() {
+      while (!camino.empty() && camino.back().i >= camino.back().nodo->count) {
+        camino.pop_back();
+      }
+    }
+
+    void siguiente_crudo() {
+      Node<TK>* node = camino.back().nodo;
+      int i = ++camino.back().i;
+      if (!node->leaf) bajar_minimo(node->children[i]);
+      normalizar();
+    }
+
+    void saltar_tombstones() {
+      while (!camino.empty() && camino.back().nodo->dead[camino.back().i]) {
+        siguiente_crudo();
+      }
+    }
+
+   public:
+    typedef forward_iterator_tag iterator_category;
+    typedef TK value_type;
+    typedef ptrdiff_t difference_type;
+    typedef const TK* pointer;
+    typedef const TK& reference;
+
+    const TK& operator*() const { return camino.back().nodo->keys[camino.back().i]; }
+    const TK* operator->() const { return &**this; }
+
+    // ocurrencias de la key actual (1 fuera del modo multiset)
+    int count() const {
+      const Paso& p = camino.back();
+      return p.nodo->counts != nullptr ? p.nodo->counts[p.i] : 1;
+    }
+
+    iterator& operator++() {
+      siguiente_crudo();
+      saltar_tombstones();
+      return *this;
+    }
+
+    // avanza hasta la primera key >= key. Solo sube hasta el ancestro cuyo
+    // rango contiene a key, asi que los subarboles intermedios se saltan
+    void seek(TK key) {
+      if (camino.empty() || !(**this < key)) return;
+      while (camino.size() > 1) {
+        const Paso& padre = camino[camino.size() - 2];
+        if (padre.i < padre.nodo->count && !(padre.nodo->keys[padre.i] < key)) break;
+        camino.pop_back();
+      }
+      Node<TK>* node = camino.back().nodo;
+      camino.pop_back();
+      bajar(node, key);
+      saltar_tombstones();
+    }
+
+    bool operator==(const iterator& other) const {
+      if (camino.empty() || other.camino.empty()) return camino.empty() && other.camino.empty();
+      return camino.back().nodo == other.camino.back().nodo && camino.back().i == other.camino.back().i;
+    }
+    bool operator!=(const iterator& other) const { return !(*this == other); }
+  };
+
+  iterator begin(){
+    iterator it = nuevo_iterador();
+    it.bajar_minimo(root);
+    it.normalizar();
+    it.saltar_tombstones();
+    return it;
+  }
+
+  iterator end(){
+    return iterator();
+  }
+
+  // primera key viva >= key
+  iterator lower_bound(TK key){
+    iterator it = nuevo_iterador();
+    it.bajar(root, key);
+    it.saltar_tombstones();
+    return it;
+  }
+
+  // busca key empezando desde el hint (finger): si key cae en el rango de su
+  // hoja o del padre baja desde ahi; si no (o si el hint no es valido) desde
+  // la raiz. El hint queda en la primera key viva >= key. Las operaciones con
+  // hint solo usan el del llamador; el dedo interno sigue a las que no lo llevan
+  bool find(iterator& hint, TK key){
+    ubicar(hint, key);
+    hint.saltar_tombstones();
+    return hint != end() && *hint == key;
+  }
+
+  // igual que find con hint, usando el dedo de la ultima operacion
+  iterator find(TK key){
+    if (filtro_descarta(key)) return end();
+    if (!find(dedo, key)) {
+      if (filtro.enabled()) filtro.false_positives++;
+      return end();
+    }
+    return dedo;
+  }
+
+ private:
+  // ultimo camino usado por insert/find/search sin hint: cache del finger. Se
+  // actualiza en el lugar, sin copiar el camino
+  iterator dedo;
+
+  iterator nuevo_iterador() {
+    iterator it;
+    reiniciar(it);
+    return it;
+  }
+
+  // vacia el camino conservando su memoria y lo asocia a la version actual
+  void reiniciar(iterator& it) {
+    it.camino.clear();
+    it.arbol = this;
+    it.version = version;
+  }
+
+  bool dedo_valido(const iterator& it) {
+    return it.arbol == this && it.version == version;
+  }
+
+  // deja it en la primera key >= key (viva o no) partiendo de su hoja o su
+  // padre si contienen a key. Retorna true si key esta viva
+  bool ubicar(iterator& it, TK key) {
+    if (!dedo_valido(it)) reiniciar(it);
+    Node<TK>* desde = it.subir_hasta(key);
+    it.bajar(desde != nullptr ? desde : root, key);
+    if (it.camino.empty()) return false;
+    const typename iterator::Paso& p = it.camino.back();
+    return p.nodo->keys[p.i] == key && !p.nodo->dead[p.i];
+  }
+
+  // inserta key partiendo del dedo (su hoja o su padre, si contienen a key),
+  // baja registrando el camino e inserta en la hoja. Los splits se propagan
+  // hacia arriba por el mismo camino. Al terminar el dedo apunta a key
+  void insertar_con_dedo(iterator& it, TK key) {
+    if (root == nullptr) {
+      root = new Node<TK>(M, multiset);
+      root->keys[0] = key;
+      root->dead[0] = false;
+      if (multiset) root->counts[0] = 1;
+      root->count = 1;
+      sumar_n(1);
+      version++;
+      reiniciar(it);
+      it.empujar(root, 0);
+      return;
+    }
+
+    Node<TK>* node = it.subir_hasta(key);
+    if (node == nullptr) node = root;
+    while (true) {
+      // se recorre desde la derecha: las keys repetidas quedan a la derecha
+      // y los appends no recorren el nodo
+      int i = node->count;
+      while (i > 0 && key < node->keys[i - 1]) i--;
+      // en modo lazy, si la key existe como tombstone basta con revivirla; en
+      // modo multiset, si existe viva solo se incrementa su contador
+      if (i > 0 && node->keys[i - 1] == key && (node->dead[i - 1] || multiset)) {
+        if (node->dead[i - 1]) {
+          node->dead[i - 1] = false;
+          if (multiset) node->counts[i - 1] = 1;
+        } else {
+          node->counts[i - 1]++;
+        }
+        sumar_n(1);
+        it.empujar(node, i - 1);
+        return;
+      }
+      if (node->leaf) {
+        for (int j = node->count; j > i; j--) mover_key(node, j, node, j - 1);
+        node->keys[i] = key;
+        node->dead[i] = false;
+        if (multiset) node->counts[i] = 1;
+        node->count++;
+        sumar_n(1);
+        it.empujar(node, i);
+        break;
+      }
+      it.empujar(node, i);
+      node = node->children[i];
+    }
+
+    if (node->count < M) return;
+
+    // la hoja se lleno: split y propagacion por el camino
+    it.camino.pop_back();
+    Node<TK>* actual = node;
+    Node<TK>* nuevo = partir(node);
+    for (int nivel = it.camino.size() - 1; ; nivel--) {
+      if (nivel < 0) {
+        Node<TK>* newRoot = new Node<TK>(M, multiset);
+        newRoot->leaf = false;
+        newRoot->count = 1;
+        mover_key(newRoot, 0, actual, actual->count);
+        newRoot->children[0] = actual;
+        newRoot->children[1] = nuevo;
+        root = newRoot;
+        break;
+      }
+      Node<TK>* padre = it.camino[nivel].nodo;
+      int i = it.camino[nivel].i;
+      for (int j = padre->count; j > i; j--) {
+        mover_key(padre, j, padre, j - 1);
+        padre->children[j + 1] = padre->children[j];
+      }
+      mover_key(padre, i, actual, actual->count);
+      padre->children[i + 1] = nuevo;
+      padre->count++;
+      if (padre->count < M) break;
+      actual = padre;
+      nuevo = partir(padre);
+    }
+
+    // el camino cambio: se vuelve a ubicar el dedo en key
+    reiniciar(it);
+    it.bajar(root, key);
+  }
+
+ public:
+  // inserta key empezando desde el hint (finger). Para keys que llegan casi
+  // ordenadas (o agrupadas) el hint ya esta en la hoja correcta y la insercion
+  // no baja desde la raiz: O(1) amortizado. El hint queda apuntando a key
+  void insert(iterator& hint, TK key){
+    if (!dedo_valido(hint)) reiniciar(hint);
+    insertar_con_dedo(hint, key);
+    al_insertar(key);
+  }
+
+  // con _multiset las keys repetidas no se duplican: cada key distinta se
+  // guarda una vez junto con su cantidad de ocurrencias
+  BTree(int _M, bool _multiset = false) : root(nullptr), M(_M), n(0), lazy(false), multiset(_multiset),
+                  umbral_tombstones(0.5), version(0),
+                  filtro_obsoleto(false), eliminados_filtro(0) {}
+
+  BTree(const BTree&) = delete;
+  BTree& operator=(const BTree&) = delete;
+
+  BTree(BTree&& other) : root(other.root), M(other.M), n(other.n),
+                         lazy(other.lazy), multiset(other.multiset),
+                         umbral_tombstones(other.umbral_tombstones), version(0),
+                         filtro(std::move(other.filtro)), filtro_obsoleto(other.filtro_obsoleto),
+                         eliminados_filtro(other.eliminados_filtro) {
+    other.root = nullptr;
+    other.n = 0;
+    other.version++;
+    other.filtro.disable();
+  }
+
+  BTree& operator=(BTree&& other) {
+    if (this != &other) {
+      clear();
+      root = other.root;
+      M = other.M;
+      n = other.n;
+      lazy = other.lazy;
+      multiset = other.multiset;
+      umbral_tombstones = other.umbral_tombstones;
+      filtro = std::move(other.filtro);
+      filtro_obsoleto = other.filtro_obsoleto;
+      eliminados_filtro = other.eliminados_filtro;
+      other.root = nullptr;
+      other.n = 0;
+      other.version++;
+      other.filtro.disable();
+    }
+    return *this;
+  }
 
   //indica si se encuentra o no un elemento
   bool search(TK key){
-    return this->search(this->root, key);
+    if (filtro_descarta(key)) return false;
+    // si key cae en la hoja del dedo (o en su padre) se empieza desde ahi, y
+    // el dedo queda en key para la siguiente busqueda
+    bool encontrado = ubicar(dedo, key);
+    if (!encontrado && filtro.enabled()) filtro.false_positives++;
+    return encontrado;
+  }
+
+  // busca varias keys; con el filtro activo las ausentes se descartan en O(1)
+  vector<bool> search_many(const vector<TK>& keys){
+    vector<bool> output(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) output[i] = search(keys[i]);
+    return output;
+  }
+
+  // Activa un filtro de Bloom por bloques para que search, search_many y
+  // find descarten en O(1) las keys que seguro no estan. bits_por_clave es
+  // por key de capacidad, y la capacidad es el doble de las keys vivas al
+  // reconstruirlo: recien construido usa ~2 * bits_por_clave por key viva y
+  // se reconstruye al llenarse. Con 10 bits la tasa de falsos positivos va
+  // de ~0.03% (recien construido) a ~1% (lleno)
+  void enable_filter(double bits_por_clave = 10){
+    filtro.reset(0, bits_por_clave);
+    reconstruir_filtro();
+  }
+
+  void disable_filter(){
+    filtro.disable();
+  }
+
+  // configuracion y contadores del filtro (queries, rejected, false_positives)
+  const BloomFilter<TK>& filter() const {
+    return filtro;
   }
 
   //Funcion auxiliar para hacer divisiones en el insert
   void splitChild(Node<TK>* parent, int childIndex) {
+    version++;
     Node<TK>* fullChild = parent->children[childIndex];
-    Node<TK>* newChild = new Node<TK>(M);
+    Node<TK>* newChild = new Node<TK>(M, multiset);
     newChild->leaf = fullChild->leaf;
     
     int mid = M / 2;
-    TK midKey = fullChild->keys[mid];
     
     // El hijo derecho recibe las keys después de mid
     newChild->count = fullChild->count - mid - 1;
     for (int i = 0; i < newChild->count; i++) {
-        newChild->keys[i] = fullChild->keys[mid + 1 + i];
+        mover_key(newChild, i, fullChild, mid + 1 + i);
     }
     
     // Si no es hoja, también copiar los hijos correspondientes
@@ -449,125 +1354,18 @@ class BTree {
     
     // Insertar midKey en el array de keys del padre
     for (int i = parent->count - 1; i >= childIndex; i--) {
-        parent->keys[i + 1] = parent->keys[i];
+        mover_key(parent, i + 1, parent, i);
     }
-    parent->keys[childIndex] = midKey;
+    mover_key(parent, childIndex, fullChild, mid);
     parent->count++;
   }
 
-  // Helper para insertar en un subárbol y manejar el split si es necesario
-  bool insertAndSplit(Node<TK>* node, TK key, TK& promotedKey, Node<TK>*& newSibling) {
-    int i = node->count - 1;
-    
-    if (node->leaf) {
-        // Insertar en hoja (permite temporalmente M keys)
-        while (i >= 0 && key < node->keys[i]) {
-            node->keys[i + 1] = node->keys[i];
-            i--;
-        }
-        node->keys[i + 1] = key;
-        node->count++;
-        
-        // Si el nodo ahora tiene M keys, necesita split
-        if (node->count == M) {
-            newSibling = new Node<TK>(M);
-            newSibling->leaf = true;
-            
-            int mid = M / 2;
-            promotedKey = node->keys[mid];
-            
-            // Copiar mitad derecha al nuevo hermano
-            newSibling->count = node->count - mid - 1;
-            for (int j = 0; j < newSibling->count; j++) {
-                newSibling->keys[j] = node->keys[mid + 1 + j];
-            }
-            
-            node->count = mid;
-            return true;  // Indica que hubo split
-        }
-        return false;  // No hubo split
-        
-    } else {
-        // Encontrar el hijo donde debe ir la key
-        while (i >= 0 && key < node->keys[i]) {
-            i--;
-        }
-        i++;
-        
-        TK childPromotedKey;
-        Node<TK>* childNewSibling = nullptr;
-        
-        // Insertar recursivamente
-        bool childDidSplit = insertAndSplit(node->children[i], key, childPromotedKey, childNewSibling);
-        
-        if (childDidSplit) {
-            // El hijo hizo split, necesitamos insertar la key promovida en este nodo
-            // Hacer espacio para la nueva key
-            for (int j = node->count; j > i; j--) {
-                node->keys[j] = node->keys[j - 1];
-                node->children[j + 1] = node->children[j];
-            }
-            
-            node->keys[i] = childPromotedKey;
-            node->children[i + 1] = childNewSibling;
-            node->count++;
-            
-            // Si ahora tenemos M keys, necesitamos split
-            if (node->count == M) {
-                newSibling = new Node<TK>(M);
-                newSibling->leaf = false;
-                
-                int mid = M / 2;
-                promotedKey = node->keys[mid];
-                
-                // Copiar mitad derecha
-                newSibling->count = node->count - mid - 1;
-                for (int j = 0; j < newSibling->count; j++) {
-                    newSibling->keys[j] = node->keys[mid + 1 + j];
-                }
-                for (int j = 0; j <= newSibling->count; j++) {
-                    newSibling->children[j] = node->children[mid + 1 + j];
-                    node->children[mid + 1 + j] = nullptr;
-                }
-                
-                node->count = mid;
-                return true;
-            }
-        }
-        
-        return false;
-    }
-  }
-
   void insert(TK key){ //inserta un elemento
-
-    // si el árbol está vacío, crear raíz
-    if (root == nullptr) {
-        root = new Node<TK>(this->M);
-        root->keys[0] = key;
-        root->count = 1;
-        root->leaf = true;
-        n++;
-        return;
-    }
-
-    TK promotedKey;
-    Node<TK>* newSibling = nullptr;
-    
-    bool didSplit = insertAndSplit(root, key, promotedKey, newSibling);
-    
-    if (didSplit) {
-        // La raíz hizo split, crear nueva raíz
-        Node<TK>* newRoot = new Node<TK>(M);
-        newRoot->leaf = false;
-        newRoot->count = 1;
-        newRoot->keys[0] = promotedKey;
-        newRoot->children[0] = root;
-        newRoot->children[1] = newSibling;
-        root = newRoot;
-    }
-    
-    n++;
+    // se parte del dedo de la ultima operacion: si key cae en la misma hoja
+    // (keys secuenciales o agrupadas) no se baja desde la raiz
+    if (!dedo_valido(dedo)) reiniciar(dedo);
+    insertar_con_dedo(dedo, key);
+    al_insertar(key);
   }
 
   // Función auxiliar para limpiar nodos vacíos recursivamente
@@ -600,26 +1398,73 @@ class BTree {
     }
   }
 
-  void remove(TK key){//elimina un elemento
+  void remove(TK key){//elimina un elemento (en modo multiset, todas sus ocurrencias)
     if (!root) return;
-    bool found = remove_recursion(root, key);
-    if (found) {
-      n--;
-      //si la raiz quedo vacia, pero este tiene un hijop, el hijo se convierte en la nueva raiz
-      if (root->count == 0 && !root->leaf) {
-        Node<TK>* old_rt = root;
-        root = root->children[0];
-        old_rt->children[0] = nullptr;
-        delete old_rt;
-      }
-
-      // si el arbol esta totalmente vacio, eliminar la raiz
-      if (root && root->count == 0 && root->leaf) {
-        delete root;
-        root = nullptr;
-      }
+    // en modo lazy solo se marca el tombstone; la purga fisica es diferida
+    if (lazy) {
+      if (marcar_tombstone(key)) al_eliminar(1);
+      return;
+    }
+    int vivos = 0;
+    if (eliminar_fisico(key, &vivos) && vivos > 0) {
+      sumar_n(-vivos);
+      al_eliminar(1);
     }
   };
+
+  // cantidad de ocurrencias de key (0 o 1 fuera del modo multiset)
+  int count(TK key){
+    if (filtro_descarta(key)) return 0;
+    int i;
+    Node<TK>* node = nodo_de(key, i);
+    if (node == nullptr || node->dead[i]) {
+      if (filtro.enabled()) filtro.false_positives++;
+      return 0;
+    }
+    return ocurrencias(node, i);
+  }
+
+  // elimina una sola ocurrencia de key: decrementa su contador en el lugar y
+  // solo la saca del arbol cuando llega a 0
+  void erase_one(TK key){
+    if (!root) return;
+    int i;
+    Node<TK>* node = nodo_de(key, i);
+    if (node == nullptr || node->dead[i]) return;
+    if (ocurrencias(node, i) > 1) {
+      node->counts[i]--;
+      sumar_n(-1);
+      return;
+    }
+    remove(key);
+  }
+
+  // elimina todas las ocurrencias de key
+  void erase_all(TK key){
+    remove(key);
+  }
+
+  // activa/desactiva la eliminacion perezosa. umbral es la proporcion de
+  // tombstones de una hoja a partir de la cual se compacta
+  void set_lazy_delete(bool activo, double umbral = 0.5){
+    lazy = activo;
+    umbral_tombstones = umbral;
+    if (!lazy) purge();
+  }
+
+  // elimina fisicamente todos los tombstones reconstruyendo el arbol en O(n)
+  void purge(){
+    if (root == nullptr) return;
+    vector<TK> vivos;
+    vector<int> conteos;
+    int muertos = recolectar_vivos(root, vivos, conteos);
+    if (muertos == 0) return;
+    version++;
+    clear_node(root);
+    root = construir_ordenado(vivos, &conteos);
+    n = 0;
+    for (int c : conteos) n += c;
+  }
   
   int height(){ //altura del arbol. Considerar altura 0 para arbol vacio
     if(root == nullptr)
@@ -653,26 +1498,51 @@ class BTree {
     return range_search(root, begin, end);
   }
 
-  TK minKey(){ // minimo valor de la llave en el arbol
-    if (root == nullptr) {
-      throw "error, arbol nulo";
+  // elimina todas las keys en [begin, end]. Corta el arbol por los dos caminos
+  // frontera, libera de una vez los subarboles cubiertos y vuelve a unir las
+  // partes rebalanceando solo los bordes: O(log n + nodos eliminados)
+  void erase_range(TK begin, TK end){
+    if (root == nullptr || end < begin) return;
+    version++;
+
+    Node<TK>* izq; Node<TK>* medio; Node<TK>* der;
+    int h_izq, h_medio, h_der;
+    dividir(root, altura(root), begin, false, izq, h_izq, der, h_der);
+    dividir(der, h_der, end, true, medio, h_medio, der, h_der);
+
+    int eliminados = contar_vivos(medio);
+    sumar_n(-eliminados);
+    al_eliminar(eliminados);
+    clear_node(medio);
+
+    if (izq == nullptr || der == nullptr) {
+      root = izq != nullptr ? izq : der;
+      return;
     }
-    Node<TK>* temp = root;
-    while(temp->leaf == false){
-        temp = temp->children[0];
-      }
-      return temp->keys[0];
+
+    // el minimo de la parte derecha pasa a ser el separador
+    root = der;
+    Slot sep = sacar(get_successor(der), 0);
+    eliminar_fisico(sep.key);
+    der = root;
+    int h;
+    root = unir(izq, h_izq, sep, der, altura(der), h);
+  }
+
+  TK minKey(){ // minimo valor de la llave en el arbol (ignora tombstones)
+    TK key;
+    if (!extremo_vivo(root, false, key)) {
+      throw "error, arbol nulo";
     }
+    return key;
+  }
      
-  TK maxKey(){ // maximo valor de la llave en el arbol
-    if (root == nullptr) {
+  TK maxKey(){ // maximo valor de la llave en el arbol (ignora tombstones)
+    TK key;
+    if (!extremo_vivo(root, true, key)) {
       throw "error, arbol nulo";
     }
-    Node<TK>* temp = root;
-    while(temp->leaf == false){
-      temp = temp->children[temp->count];
-    }
-    return temp->keys[temp->count-1];
+    return key;
   }
 
   void clear_node(Node<TK>* nodo){
@@ -689,18 +1559,192 @@ class BTree {
 
     delete nodo;
   }
+  // parte el arbol en dos: first con las keys < key y second con las >= key.
+  // Empalma subarboles a alturas iguales en O(log n); el arbol queda vacio.
+  // El size() de cada parte se recuenta la primera vez que se pide; insert y
+  // remove no fuerzan ese recuento
+  pair<BTree, BTree> split(TK key){
+    return split(key, -1);
+  }
+
+ private:
+  template <typename> friend class ShardedBTree;
+
+  // split para quien ya sabe cuantos elementos son menores que key: ambas
+  // partes quedan con su size() sin recuento. No se verifica, asi que solo lo
+  // usa ShardedBTree, que los cuenta al recorrer el shard buscando la mediana
+  pair<BTree, BTree> split(TK key, int menores){
+    pair<BTree, BTree> partes{BTree(M, multiset), BTree(M, multiset)};
+    version++;
+    int h_izq, h_der;
+    dividir(root, altura(root), key, false, partes.first.root, h_izq, partes.second.root, h_der);
+    bool conocido = menores >= 0 && n >= 0;
+    partes.first.n = conocido ? menores : -1;
+    partes.second.n = conocido ? n - menores : -1;
+    root = nullptr;
+    n = 0;
+    for (BTree* parte : {&partes.first, &partes.second}) {
+      parte->lazy = lazy;
+      parte->umbral_tombstones = umbral_tombstones;
+      if (filtro.enabled()) {
+        // cada parte reconstruye su filtro en la primera consulta
+        parte->filtro.reset(0, filtro.bits_per_key());
+        parte->filtro_obsoleto = true;
+      }
+    }
+    return partes;
+  }
+
+ public:
+  // concatena other al final de este arbol en O(log n). Todas las keys de
+  // este arbol deben ser menores que las de other; other queda vacio
+  void join(BTree&& other){
+    if (other.M != M) {
+      throw "error, arboles de distinto orden";
+    }
+    if (other.multiset != multiset) {
+      throw "error, arboles de distinto modo";
+    }
+    if (other.root == nullptr) return;
+    version++;
+    other.version++;
+    filtro_obsoleto = true; // las keys de other no estan en el filtro
+    if (root == nullptr) {
+      root = other.root;
+      n = other.n;
+      other.root = nullptr;
+      other.n = 0;
+      return;
+    }
+
+    Node<TK>* ultima = root;
+    while (!ultima->leaf) ultima = ultima->children[ultima->count];
+    Node<TK>* primera = get_successor(other.root);
+    if (!(ultima->keys[ultima->count - 1] < primera->keys[0])) {
+      throw "error, los rangos de keys se solapan";
+    }
+
+    n = (n < 0 || other.n < 0) ? -1 : n + other.n;
+
+    // el minimo de other pasa a ser el separador
+    Slot sep = sacar(primera, 0);
+    other.eliminar_fisico(sep.key);
+    int h;
+    root = unir(root, altura(root), sep, other.root, altura(other.root), h);
+    other.root = nullptr;
+    other.n = 0;
+  }
+
+  // Operaciones de conjuntos: recorren ambos arboles en orden y construyen el
+  // resultado de abajo hacia arriba en O(n + m). La interseccion y la
+  // diferencia usan seek para saltar los subarboles que no se solapan. En modo
+  // multiset operan sobre las keys distintas y el resultado es un conjunto
+  BTree set_union(BTree& other){
+    vector<TK> out;
+    iterator a = begin(), b = other.begin();
+    while (a != end() && b != other.end()) {
+      if (*a < *b) { out.push_back(*a); ++a; }
+      else if (*b < *a) { out.push_back(*b); ++b; }
+      else { out.push_back(*a); ++a; ++b; }
+    }
+    for (; a != end(); ++a) out.push_back(*a);
+    for (; b != other.end(); ++b) out.push_back(*b);
+    return desde_ordenado(out);
+  }
+
+  BTree set_intersection(BTree& other){
+    vector<TK> out;
+    iterator a = begin(), b = other.begin();
+    while (a != end() && b != other.end()) {
+      if (*a < *b) a.seek(*b);
+      else if (*b < *a) b.seek(*a);
+      else { out.push_back(*a); ++a; ++b; }
+    }
+    return desde_ordenado(out);
+  }
+
+  // keys de este arbol que no estan en other
+  BTree set_difference(BTree& other){
+    vector<TK> out;
+    iterator a = begin(), b = other.begin();
+    while (a != end() && b != other.end()) {
+      if (*a < *b) { out.push_back(*a); ++a; }
+      else if (*b < *a) b.seek(*a);
+      else { ++a; ++b; }
+    }
+    for (; a != end(); ++a) out.push_back(*a);
+    return desde_ordenado(out);
+  }
+
+  // agrega las keys de other a este arbol; other queda vacio. Si los rangos
+  // no se solapan se concatenan con join en O(log n). En modo multiset las
+  // ocurrencias de las keys comunes se suman
+  void merge(BTree&& other){
+    if (other.root == nullptr) return;
+    if (other.M == M && other.multiset == multiset) {
+      Node<TK>* ultima = root;
+      while (ultima != nullptr && !ultima->leaf) ultima = ultima->children[ultima->count];
+      Node<TK>* ultima_other = other.root;
+      while (!ultima_other->leaf) ultima_other = ultima_other->children[ultima_other->count];
+
+      if (root == nullptr || ultima->keys[ultima->count - 1] < get_successor(other.root)->keys[0]) {
+        join(std::move(other));
+        return;
+      }
+      if (ultima_other->keys[ultima_other->count - 1] < get_successor(root)->keys[0]) {
+        other.join(std::move(*this));
+        root = other.root;
+        n = other.n;
+        filtro_obsoleto = true;
+        other.root = nullptr;
+        other.n = 0;
+        return;
+      }
+    }
+    BTree unido = multiset ? suma(other) : set_union(other);
+    unido.lazy = lazy;
+    unido.umbral_tombstones = umbral_tombstones;
+    if (filtro.enabled()) {
+      unido.filtro.reset(0, filtro.bits_per_key());
+      unido.filtro_obsoleto = true;
+    }
+    *this = std::move(unido);
+    other.clear();
+  }
+
   void clear(){ // eliminar todos lo elementos del arbol
+    version++;
+    filtro_obsoleto = true;
     clear_node(root);
     root = nullptr;
     n = 0;
     return;
   } 
   
-  int size(){ // retorna el total de elementos insertados
+  bool is_multiset() const {
+    return multiset;
+  }
+
+  int size(){ // retorna el total de elementos insertados (con repeticiones en modo multiset)
+    asegurar_n();
     return n;
   } 
   
 
+  // Construye en O(n), de abajo hacia arriba, un árbol B a partir de keys
+  // ordenadas y sin repetidos
+  static BTree build_from_sorted(const vector<TK>& elements, int M){
+    BTree vacio(M);
+    return vacio.desde_ordenado(elements);
+  }
+
+  // igual, pero el resultado es un multiset: counts trae las ocurrencias de
+  // cada key (paralelo a elements)
+  static BTree build_from_sorted(const vector<TK>& elements, const vector<int>& counts, int M){
+    BTree vacio(M);
+    return vacio.desde_ordenado(elements, &counts);
+  }
+
   // Construya un árbol B a partir de un vector de elementos ordenados
   static BTree* build_from_ordered_vector(vector<TK> elements, int M){
     BTree* resultado = new BTree(M);
@@ -720,28 +1764,122 @@ class BTree {
   //➢ Cada nodo excepto la raíz, ⌈M/2⌉ - 1<= numero de keys <= M - 1
   //➢ Cada nodo interno excepto la raiz, ⌈M/2⌉ <= número de hijos <= M
   bool check_properties(){
-    
-    if (root == nullptr){
-      return true;
-    }
-    
-    //verificar keys ordenadas
-    if (!verificar_keys_ordenadas(root)){
-      return false;
+    return verify().ok;
+  }
+
+  // Verificacion completa en una sola pasada. Ademas de las propiedades de
+  // check_properties revisa las cotas de los separadores entre niveles, los
+  // punteros a hijos y que size() coincida con las keys vivas. En arboles
+  // grandes los subarboles se reparten entre hilos
+  PropertyReport verify(){
+    PropertyReport r;
+    if (root == nullptr) {
+      if (n > 0) {
+        r.ok = false;
+        r.violation = PropertyReport::SIZE_MISMATCH;
+        r.message = "arbol vacio con size() = " + to_string(n);
+      }
+      return r;
     }
-    
-    // verificar que todas las hojas estén al mismo nivel
-    if (!verificar_altura_hojas(root)) {
-      return false;
+    int h = altura(root);
+    long long vivos = 0;
+
+    // con pocos elementos no vale la pena lanzar hilos. Si size() esta
+    // pendiente se usa la cota inferior de keys que da la altura
+    unsigned hilos = thread::hardware_concurrency();
+    long long estimado = n >= 0 ? n : minimo_keys(h);
+    if (hilos <= 1 || estimado < MIN_VERIFICACION_PARALELA) {
+      vivos = verificar_subarbol(root, 0, h, nullptr, nullptr, r);
+      if (vivos < 0) return r;
+    } else {
+      // se expanden los niveles superiores hasta tener suficientes subarboles
+      vector<TareaVerificacion> frontera = {{root, 0, nullptr, nullptr, {}}};
+      while (frontera.size() < 4 * hilos && !frontera[0].nodo->leaf) {
+        vector<TareaVerificacion> siguiente;
+        for (TareaVerificacion& t : frontera) {
+          r.path = t.camino;
+          if (!verificar_nodo(t.nodo, t.nivel, h, t.lo, t.hi, r)) return r;
+          vivos += vivos_en_nodo(t.nodo);
+          for (int i = 0; i <= t.nodo->count; i++) {
+            TareaVerificacion hijo = {t.nodo->children[i], t.nivel + 1,
+                                      i > 0 ? &t.nodo->keys[i - 1] : t.lo,
+                                      i < t.nodo->count ? &t.nodo->keys[i] : t.hi, t.camino};
+            hijo.camino.push_back(i);
+            siguiente.push_back(hijo);
+          }
+        }
+        frontera.swap(siguiente);
+      }
+      r.path.clear();
+
+      // cada hilo verifica un bloque contiguo de subarboles, de izquierda a derecha
+      int grupos = min<int>(hilos, frontera.size());
+      vector<future<PropertyReport>> tareas;
+      vector<long long> vivos_grupo(grupos, 0);
+      for (int g = 0; g < grupos; g++) {
+        tareas.push_back(async(launch::async, [this, &frontera, &vivos_grupo, g, grupos, h]() {
+          PropertyReport pr;
+          size_t desde = frontera.size() * g / grupos, hasta = frontera.size() * (g + 1) / grupos;
+          for (size_t j = desde; j < hasta; j++) {
+            const TareaVerificacion& t = frontera[j];
+            pr.path = t.camino;
+            long long c = verificar_subarbol(t.nodo, t.nivel, h, t.lo, t.hi, pr);
+            if (c < 0) break;
+            vivos_grupo[g] += c;
+          }
+          return pr;
+        }));
+      }
+
+      // se reporta la violacion del primer grupo (en orden) que falle
+      long long revisados = r.nodes_checked;
+      for (int g = 0; g < grupos; g++) {
+        PropertyReport pr = tareas[g].get();
+        revisados += pr.nodes_checked;
+        if (!pr.ok && r.ok) r = pr;
+        vivos += vivos_grupo[g];
+      }
+      r.nodes_checked = revisados;
+      if (!r.ok) return r;
+      r.path.clear();
     }
-    
-    // verificar límites de keys y children para los nodos
-    if (!verificar_limites_nodos(root, true)) {
-      return false;
+
+    if (n >= 0 && vivos != n) {
+      r.ok = false;
+      r.violation = PropertyReport::SIZE_MISMATCH;
+      r.message = "size() = " + to_string(n) + " pero el arbol tiene " + to_string(vivos) + " keys vivas";
     }
-    
-    std::cerr << "[CHECK] All properties OK" << std::endl;
-    return true;
+    return r;
+  }
+
+  // Verificacion por muestreo: revisa caminos aleatorios raiz-hoja hasta
+  // agotar el presupuesto de tiempo (al menos uno). No puede validar size()
+  PropertyReport verify_sampled(chrono::microseconds presupuesto, unsigned semilla = 0){
+    PropertyReport r;
+    if (root == nullptr) return r;
+    int h = altura(root);
+    mt19937 rng(semilla);
+    auto limite = chrono::steady_clock::now() + presupuesto;
+
+    do {
+      Node<TK>* nodo = root;
+      const TK* lo = nullptr;
+      const TK* hi = nullptr;
+      r.path.clear();
+      for (int nivel = 0; ; nivel++) {
+        if (!verificar_nodo(nodo, nivel, h, lo, hi, r)) return r;
+        if (nodo->leaf) break;
+        int i = rng() % (nodo->count + 1);
+        if (i > 0) lo = &nodo->keys[i - 1];
+        if (i < nodo->count) hi = &nodo->keys[i];
+        r.path.push_back(i);
+        nodo = nodo->children[i];
+      }
+      r.paths_checked++;
+    } while (chrono::steady_clock::now() < limite);
+
+    r.path.clear();
+    return r;
   }
 
 
@@ -0,0 +1,258 @@
+#ifndef FROZEN_BTREE_H
+#define FROZEN_BTREE_H
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#include "btree.h"
+
+using namespace std;
+
+// cantidad de keys por bloque de un FrozenBTree
+const int FROZEN_BLOQUE = 16;
+
+// cuenta las keys de un bloque menores que x
+template <typename TK>
+inline int contar_menores(const TK* bloque, TK x) {
+  int total = 0;
+  for (int i = 0; i < FROZEN_BLOQUE; i++) total += bloque[i] < x;
+  return total;
+}
+
+#if defined(__SSE2__)
+// para int el bloque ocupa una linea de cache y se compara con SIMD
+inline int contar_menores(const int* bloque, int x) {
+#if defined(__AVX2__)
+  __m256i xv = _mm256_set1_epi32(x);
+  __m256i a = _mm256_cmpgt_epi32(xv, _mm256_load_si256((const __m256i*)bloque));
+  __m256i b = _mm256_cmpgt_epi32(xv, _mm256_load_si256((const __m256i*)(bloque + 8)));
+  int mascara = _mm256_movemask_ps(_mm256_castsi256_ps(a)) |
+                (_mm256_movemask_ps(_mm256_castsi256_ps(b)) << 8);
+#else
+  __m128i xv = _mm_set1_epi32(x);
+  int mascara = 0;
+  for (int i = 0; i < 4; i++) {
+    __m128i c = _mm_cmpgt_epi32(xv, _mm_load_si128((const __m128i*)(bloque + 4 * i)));
+    mascara |= _mm_movemask_ps(_mm_castsi128_ps(c)) << (4 * i);
+  }
+#endif
+  return __builtin_popcount(mascara);
+}
+#endif
+
+// Arbol B de solo lectura sin punteros (layout S+ tree). Todas las keys viven
+// en un unico arreglo contiguo dividido en capas de bloques de FROZEN_BLOQUE
+// keys: primero las capas internas desde la raiz y al final las hojas con
+// todas las keys ordenadas. El hijo c del bloque j es el bloque
+// j * (FROZEN_BLOQUE + 1) + c de la capa siguiente, asi que no se guardan
+// punteros. Los huecos se rellenan con +infinito (o el maximo de TK si no
+// tiene infinito), que nunca es menor que una key buscada. Si se congela un
+// BTree multiset, las ocurrencias de cada key se guardan en un arreglo
+// paralelo a las hojas y thaw las devuelve
+template <typename TK>
+class FrozenBTree {
+  static_assert(is_arithmetic<TK>::value, "FrozenBTree necesita keys aritmeticas");
+
+ private:
+  TK* datos;
+  int n;                   // keys distintas en las hojas
+  bool multiset;           // se congelo un BTree multiset
+  vector<int> conteos;     // multiset: ocurrencias de cada hoja
+  int ocurrencias_total;   // size(): n o la suma de conteos
+  vector<int> inicio_capa; // primer bloque de cada capa; la ultima capa son las hojas
+  int total_bloques;
+
+  const TK* bloque(int capa, int j) const {
+    return datos + (inicio_capa[capa] + j) * FROZEN_BLOQUE;
+  }
+
+  const TK* hojas() const {
+    return datos + inicio_capa.back() * FROZEN_BLOQUE;
+  }
+
+  int bloques_en(int capa) const {
+    int fin = capa + 1 < (int)inicio_capa.size() ? inicio_capa[capa + 1] : total_bloques;
+    return fin - inicio_capa[capa];
+  }
+
+  static TK relleno() {
+    return numeric_limits<TK>::has_infinity ? numeric_limits<TK>::infinity() : numeric_limits<TK>::max();
+  }
+
+  void construir(const vector<TK>& keys) {
+    n = keys.size();
+    ocurrencias_total = n;
+    if (n == 0) return;
+
+    // cantidad de bloques por capa, de las hojas hacia la raiz
+    vector<int> bloques = {(n + FROZEN_BLOQUE - 1) / FROZEN_BLOQUE};
+    while (bloques.back() > 1) {
+      bloques.push_back((bloques.back() + FROZEN_BLOQUE) / (FROZEN_BLOQUE + 1));
+    }
+    int capas = bloques.size();
+    int total = 0;
+    for (int c = capas - 1; c >= 0; c--) {
+      inicio_capa.push_back(total);
+      total += bloques[c];
+    }
+    total_bloques = total;
+
+    // cada bloque ocupa lineas de cache completas
+    size_t bytes = (size_t)total * FROZEN_BLOQUE * sizeof(TK);
+    bytes = (bytes + 63) / 64 * 64;
+    datos = static_cast<TK*>(aligned_alloc(64, bytes));
+    for (int i = 0; i < total * FROZEN_BLOQUE; i++) datos[i] = relleno();
+
+    TK* hoja = datos + inicio_capa.back() * FROZEN_BLOQUE;
+    for (int i = 0; i < n; i++) hoja[i] = keys[i];
+
+    // minimos de cada bloque de la capa inferior; la key t de un bloque
+    // interno es el minimo de su hijo t + 1
+    vector<TK> minimos(bloques[0]);
+    for (int j = 0; j < bloques[0]; j++) minimos[j] = hoja[j * FROZEN_BLOQUE];
+    for (int c = capas - 2; c >= 0; c--) {
+      int hijos = minimos.size();
+      TK* capa = datos + inicio_capa[c] * FROZEN_BLOQUE;
+      vector<TK> siguientes;
+      for (int j = 0; j * (FROZEN_BLOQUE + 1) < hijos; j++) {
+        int primero = j * (FROZEN_BLOQUE + 1);
+        siguientes.push_back(minimos[primero]);
+        for (int t = 0; t < FROZEN_BLOQUE && primero + t + 1 < hijos; t++) {
+          capa[j * FROZEN_BLOQUE + t] = minimos[primero + t + 1];
+        }
+      }
+      minimos.swap(siguientes);
+    }
+  }
+
+ public:
+  // a partir de keys ordenadas y sin repetidos
+  FrozenBTree(const vector<TK>& ordenadas) : datos(nullptr), n(0), multiset(false), ocurrencias_total(0), total_bloques(0) {
+    construir(ordenadas);
+  }
+
+  // congela las keys vivas de un BTree, con sus ocurrencias si es multiset
+  FrozenBTree(BTree<TK>& arbol)
+      : datos(nullptr), n(0), multiset(arbol.is_multiset()), ocurrencias_total(0), total_bloques(0) {
+    vector<TK> keys;
+    for (auto it = arbol.begin(); it != arbol.end(); ++it) {
+      keys.push_back(*it);
+      if (multiset) conteos.push_back(it.count());
+    }
+    construir(keys);
+    if (multiset) {
+      ocurrencias_total = 0;
+      for (int c : conteos) ocurrencias_total += c;
+    }
+  }
+
+  FrozenBTree(const FrozenBTree&) = delete;
+  FrozenBTree& operator=(const FrozenBTree&) = delete;
+
+  FrozenBTree(FrozenBTree&& other) : datos(other.datos), n(other.n), multiset(other.multiset),
+                                     conteos(std::move(other.conteos)),
+                                     ocurrencias_total(other.ocurrencias_total),
+                                     inicio_capa(std::move(other.inicio_capa)), total_bloques(other.total_bloques) {
+    other.datos = nullptr;
+    other.n = 0;
+    other.conteos.clear();
+    other.ocurrencias_total = 0;
+    other.total_bloques = 0;
+  }
+
+  FrozenBTree& operator=(FrozenBTree&& other) {
+    if (this != &other) {
+      free(datos);
+      datos = other.datos;
+      n = other.n;
+      multiset = other.multiset;
+      conteos = std::move(other.conteos);
+      ocurrencias_total = other.ocurrencias_total;
+      inicio_capa = std::move(other.inicio_capa);
+      total_bloques = other.total_bloques;
+      other.datos = nullptr;
+      other.n = 0;
+      other.conteos.clear();
+      other.ocurrencias_total = 0;
+      other.total_bloques = 0;
+    }
+    return *this;
+  }
+
+  ~FrozenBTree() {
+    free(datos);
+  }
+
+  // primera key >= key; end() si no hay ninguna
+  const TK* lower_bound(TK key) const {
+    if (n == 0) return nullptr;
+    int j = 0;
+    int capas = inicio_capa.size();
+    for (int c = 0; c + 1 < capas; c++) {
+      j = j * (FROZEN_BLOQUE + 1) + contar_menores(bloque(c, j), key);
+      // el hijo nunca pasa del ultimo bloque real de la capa, aunque la key
+      // supere al relleno
+      j = min(j, bloques_en(c + 1) - 1);
+    }
+    int pos = j * FROZEN_BLOQUE + contar_menores(bloque(capas - 1, j), key);
+    return hojas() + min(pos, n);
+  }
+
+  bool search(TK key) const {
+    const TK* p = lower_bound(key);
+    return p != end() && *p == key;
+  }
+
+  // cantidad de ocurrencias de key (0 o 1 si no viene de un multiset)
+  int count(TK key) const {
+    const TK* p = lower_bound(key);
+    if (p == end() || !(*p == key)) return 0;
+    return !multiset ? 1 : conteos[p - hojas()];
+  }
+
+  // como en BTree, cada key se repite tantas veces como ocurrencias tenga
+  vector<TK> rangeSearch(TK begin, TK end) const {
+    vector<TK> output;
+    for (const TK* p = lower_bound(begin); p != this->end() && !(end < *p); p++) {
+      int veces = !multiset ? 1 : conteos[p - hojas()];
+      output.insert(output.end(), veces, *p);
+    }
+    return output;
+  }
+
+  // las hojas estan ordenadas y contiguas: se recorren como un arreglo. En un
+  // multiset cada key distinta aparece una vez (ver count)
+  const TK* begin() const { return n == 0 ? nullptr : hojas(); }
+  const TK* end() const { return n == 0 ? nullptr : hojas() + n; }
+
+  TK minKey() const {
+    if (n == 0) {
+      throw "error, arbol nulo";
+    }
+    return hojas()[0];
+  }
+
+  TK maxKey() const {
+    if (n == 0) {
+      throw "error, arbol nulo";
+    }
+    return hojas()[n - 1];
+  }
+
+  // total de elementos, con repeticiones si viene de un multiset
+  int size() const {
+    return ocurrencias_total;
+  }
+
+  // vuelve a un BTree mutable de orden M, construido en O(n). Si se congelo
+  // un multiset el resultado tambien lo es, con las mismas ocurrencias
+  BTree<TK> thaw(int M) const {
+    if (multiset) return BTree<TK>::build_from_sorted(vector<TK>(begin(), end()), conteos, M);
+    return BTree<TK>::build_from_sorted(vector<TK>(begin(), end()), M);
+  }
+};
+
+#endif
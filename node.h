@@ -15,12 +15,20 @@ struct Node {
   int count;
   // indicador de nodo hoja
   bool leaf;
+  // marcas de eliminacion logica (tombstones), paralelo a keys
+  bool* dead;
+  // ocurrencias de cada key en modo multiset, paralelo a keys (nullptr si no)
+  int* counts;
 
-  Node() : keys(nullptr), children(nullptr), count(0), M(0), leaf(true) {}
-  Node(int m) : M(m) {
-    keys = new TK[M - 1];
-    children = new Node<TK>*[M];
-    for (int i = 0; i < M; ++i) children[i] = nullptr;
+  Node() : keys(nullptr), children(nullptr), count(0), M(0), leaf(true), dead(nullptr), counts(nullptr) {}
+  Node(int m, bool con_conteos = false) : M(m) {
+    // se reserva una key y un hijo extra para el overflow temporal antes del split
+    keys = new TK[M];
+    children = new Node<TK>*[M + 1];
+    for (int i = 0; i <= M; ++i) children[i] = nullptr;
+    dead = new bool[M];
+    for (int i = 0; i < M; ++i) dead[i] = false;
+    counts = con_conteos ? new int[M] : nullptr;
     count = 0;
     leaf = true;
   }
@@ -28,8 +36,10 @@ struct Node {
   ~Node(){
     if (keys != nullptr) delete[] keys;
     if (children != nullptr) delete[] children;
+    if (dead != nullptr) delete[] dead;
+    if (counts != nullptr) delete[] counts;
   }
 
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,249 @@
+#ifndef SHARDED_BTREE_H
+#define SHARDED_BTREE_H
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <vector>
+#include "btree.h"
+
+using namespace std;
+
+// BTree concurrente particionado en N shards, cada uno con su propio lock.
+// Las operaciones puntuales solo bloquean el shard de la key; los recorridos
+// mezclan los shards en orden. La particion puede ser por rangos (limites
+// ordenados) o por hash (solo para cargas de operaciones puntuales)
+template <typename TK>
+class ShardedBTree {
+ public:
+  enum Particion { POR_RANGO, POR_HASH };
+
+ private:
+  struct Shard {
+    BTree<TK> arbol;
+    mutex candado;
+    Shard(int M) : arbol(M) {}
+  };
+
+  int M;
+  Particion modo;
+  vector<unique_ptr<Shard>> shards;
+  vector<TK> limites;      // POR_RANGO: el shard i guarda las keys en [limites[i-1], limites[i])
+  int max_por_shard;       // POR_RANGO: tamaño que dispara la division automatica (0 = nunca)
+  shared_mutex directorio; // exclusivo solo mientras se dividen o unen shards
+
+  int shard_de(TK key) const {
+    if (modo == POR_RANGO) {
+      return upper_bound(limites.begin(), limites.end(), key) - limites.begin();
+    }
+    // mezcla final de murmur3: std::hash de enteros suele ser la identidad
+    unsigned long long h = hash<TK>()(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h % shards.size();
+  }
+
+  // mezcla k listas ordenadas en una sola
+  static vector<TK> mezclar(const vector<vector<TK>>& listas) {
+    vector<TK> output;
+    typedef pair<TK, pair<int, int>> Cabeza; // (key, (lista, posicion))
+    priority_queue<Cabeza, vector<Cabeza>, greater<Cabeza>> heap;
+    for (int i = 0; i < (int)listas.size(); i++) {
+      if (!listas[i].empty()) heap.push({listas[i][0], {i, 0}});
+    }
+    while (!heap.empty()) {
+      Cabeza c = heap.top();
+      heap.pop();
+      output.push_back(c.first);
+      int i = c.second.first, j = c.second.second + 1;
+      if (j < (int)listas[i].size()) heap.push({listas[i][j], {i, j}});
+    }
+    return output;
+  }
+
+  // une las listas de cada shard en orden
+  vector<TK> unir_listas(const vector<vector<TK>>& listas) const {
+    if (modo == POR_HASH) return mezclar(listas);
+    // los rangos son disjuntos y estan ordenados: basta con concatenar
+    vector<TK> output;
+    for (const vector<TK>& l : listas) output.insert(output.end(), l.begin(), l.end());
+    return output;
+  }
+
+  void dividir_grandes() {
+    unique_lock<shared_mutex> exclusivo(directorio);
+    for (int i = 0; i < (int)shards.size(); i++) {
+      if (shards[i]->arbol.size() > max_por_shard) dividir_shard(i);
+    }
+  }
+
+  // parte el shard i por su mediana. Retorna false si el shard tiene una sola
+  // key distinta y no se puede partir. Requiere el directorio en exclusivo
+  bool dividir_shard(int i) {
+    BTree<TK>& arbol = shards[i]->arbol;
+    int mitad = arbol.size() / 2;
+    if (mitad == 0) return false;
+    auto it = arbol.begin();
+    int inicio_racha = 0; // primera posicion de la racha de keys iguales a la actual
+    for (int k = 0; k < mitad; k++) {
+      TK anterior = *it;
+      ++it;
+      if (anterior < *it) inicio_racha = k + 1;
+    }
+    TK mediana = *it;
+    if (inicio_racha == 0) {
+      // la racha de la mediana arranca en la primera key: cortar ahi dejaria
+      // el shard vacio, asi que se corta al final de la racha
+      for (inicio_racha = mitad; it != arbol.end() && !(mediana < *it); ++it) inicio_racha++;
+      if (it == arbol.end()) return false;
+      mediana = *it;
+    }
+
+    // las keys antes de la racha de la mediana son las menores: con eso ambas
+    // partes conocen su size() sin recontarse
+    auto partes = arbol.split(mediana, inicio_racha);
+    arbol = std::move(partes.first);
+    unique_ptr<Shard> nuevo(new Shard(M));
+    nuevo->arbol = std::move(partes.second);
+    shards.insert(shards.begin() + i + 1, std::move(nuevo));
+    limites.insert(limites.begin() + i, mediana);
+    return true;
+  }
+
+ public:
+  // particion por rangos: limites ordenados definen limites.size() + 1 shards
+  ShardedBTree(int _M, const vector<TK>& _limites, int _max_por_shard = 0)
+      : M(_M), modo(POR_RANGO), limites(_limites), max_por_shard(_max_por_shard) {
+    for (int i = 0; i <= (int)limites.size(); i++) shards.emplace_back(new Shard(M));
+  }
+
+  // particion por hash en num_shards shards
+  ShardedBTree(int _M, int num_shards) : M(_M), modo(POR_HASH), max_por_shard(0) {
+    for (int i = 0; i < num_shards; i++) shards.emplace_back(new Shard(M));
+  }
+
+  void insert(TK key) {
+    bool dividir;
+    {
+      shared_lock<shared_mutex> lectura(directorio);
+      Shard& s = *shards[shard_de(key)];
+      lock_guard<mutex> guard(s.candado);
+      s.arbol.insert(key);
+      dividir = max_por_shard > 0 && s.arbol.size() > max_por_shard;
+    }
+    if (dividir) dividir_grandes();
+  }
+
+  void remove(TK key) {
+    shared_lock<shared_mutex> lectura(directorio);
+    Shard& s = *shards[shard_de(key)];
+    lock_guard<mutex> guard(s.candado);
+    s.arbol.remove(key);
+  }
+
+  bool search(TK key) {
+    shared_lock<shared_mutex> lectura(directorio);
+    Shard& s = *shards[shard_de(key)];
+    lock_guard<mutex> guard(s.candado);
+    return s.arbol.search(key);
+  }
+
+  // cada shard se lee de forma consistente, pero no todos en el mismo instante
+  vector<TK> rangeSearch(TK begin, TK end) {
+    shared_lock<shared_mutex> lectura(directorio);
+    int desde = 0, hasta = shards.size() - 1;
+    if (modo == POR_RANGO) {
+      desde = shard_de(begin);
+      hasta = shard_de(end);
+    }
+    vector<vector<TK>> listas;
+    for (int i = desde; i <= hasta; i++) {
+      lock_guard<mutex> guard(shards[i]->candado);
+      listas.push_back(shards[i]->arbol.rangeSearch(begin, end));
+    }
+    return unir_listas(listas);
+  }
+
+  // todas las keys en orden
+  vector<TK> keys() {
+    shared_lock<shared_mutex> lectura(directorio);
+    vector<vector<TK>> listas;
+    for (auto& s : shards) {
+      lock_guard<mutex> guard(s->candado);
+      listas.push_back(vector<TK>(s->arbol.begin(), s->arbol.end()));
+    }
+    return unir_listas(listas);
+  }
+
+  int size() {
+    shared_lock<shared_mutex> lectura(directorio);
+    int total = 0;
+    for (auto& s : shards) {
+      lock_guard<mutex> guard(s->candado);
+      total += s->arbol.size();
+    }
+    return total;
+  }
+
+  // tamaño de cada shard, en orden
+  vector<int> shard_sizes() {
+    shared_lock<shared_mutex> lectura(directorio);
+    vector<int> sizes;
+    for (auto& s : shards) {
+      lock_guard<mutex> guard(s->candado);
+      sizes.push_back(s->arbol.size());
+    }
+    return sizes;
+  }
+
+  // Rebalancea la particion por rangos segun el size() de cada shard: parte
+  // por la mediana los que superan factor veces el promedio y une pares
+  // vecinos que juntos no llegan a la mitad del promedio o que estan vacios
+  // (si se vaciaron todos el promedio es 0). Con hash la carga ya queda
+  // repartida y no hace nada
+  void rebalance(double factor = 2.0) {
+    if (modo == POR_HASH) return;
+    unique_lock<shared_mutex> exclusivo(directorio);
+
+    long long total = 0;
+    for (auto& s : shards) total += s->arbol.size();
+    double promedio = (double)total / shards.size();
+
+    for (int i = 0; i < (int)shards.size(); i++) {
+      if (shards[i]->arbol.size() > factor * promedio && dividir_shard(i)) i++;
+    }
+    for (int i = 0; i + 1 < (int)shards.size(); ) {
+      long long juntos = shards[i]->arbol.size() + shards[i + 1]->arbol.size();
+      if (juntos == 0 || juntos < promedio / 2) {
+        shards[i]->arbol.join(std::move(shards[i + 1]->arbol));
+        shards.erase(shards.begin() + i + 1);
+        limites.erase(limites.begin() + i);
+      } else {
+        i++;
+      }
+    }
+  }
+
+  int shard_count() {
+    shared_lock<shared_mutex> lectura(directorio);
+    return shards.size();
+  }
+
+  bool check_properties() {
+    unique_lock<shared_mutex> exclusivo(directorio);
+    for (int i = 0; i < (int)shards.size(); i++) {
+      BTree<TK>& arbol = shards[i]->arbol;
+      if (!arbol.check_properties()) return false;
+      if (modo == POR_RANGO && arbol.size() > 0) {
+        if (i > 0 && arbol.minKey() < limites[i - 1]) return false;
+        if (i < (int)limites.size() && !(arbol.maxKey() < limites[i])) return false;
+      }
+    }
+    return true;
+  }
+};
+
+#endif
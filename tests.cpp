@@ -0,0 +1,575 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "btree.h"
+#include "frozen_btree.h"
+#include "sharded_btree.h"
+#include "tester.h"
+
+using namespace std;
+
+// Pruebas de las operaciones del BTree que no cubre main.cpp (que no se
+// modifica). Cada bloque compara contra std::set/std::map en corridas
+// aleatorias con semilla fija.
+// Uso: g++ -std=c++17 -pthread tests.cpp -o tests && ./tests
+
+vector<int> keys_de(BTree<int>& t) {
+  return vector<int>(t.begin(), t.end());
+}
+
+vector<int> rango(int desde, int hasta) {
+  vector<int> v;
+  for (int i = desde; i < hasta; i++) v.push_back(i);
+  return v;
+}
+
+// tombstones: marcar, revivir, compactar hojas y purge
+void probar_lazy_delete() {
+  BTree<int> t(5);
+  for (int i = 0; i < 100; i++) t.insert(i);
+  t.set_lazy_delete(true);
+  t.remove(10);
+  t.remove(10);
+  ASSERT(t.size() == 99, "remove en modo lazy no actualiza size");
+  ASSERT(!t.search(10), "search no salta los tombstones");
+  ASSERT(t.rangeSearch(8, 12) == vector<int>({8, 9, 11, 12}), "rangeSearch no salta los tombstones");
+  ASSERT(t.find(10) == t.end() && *t.lower_bound(10) == 11, "el iterador no salta los tombstones");
+  t.insert(10);
+  ASSERT(t.search(10) && t.size() == 100 && t.check_properties(), "insert no revive el tombstone");
+
+  t.remove(0);
+  t.remove(99);
+  ASSERT(t.minKey() == 1 && t.maxKey() == 98, "minKey/maxKey no ignoran los tombstones");
+
+  mt19937 rng(26);
+  set<int> ref(t.begin(), t.end());
+  bool ok = true;
+  for (int i = 0; i < 20000; i++) {
+    int k = rng() % 500;
+    if (rng() % 3 == 0) {
+      if (ref.insert(k).second) t.insert(k); // fuera del modo multiset insert duplica
+    } else {
+      t.remove(k);
+      ref.erase(k);
+    }
+    if (i % 1000 == 0) ok &= t.verify().ok;
+  }
+  ok &= keys_de(t) == vector<int>(ref.begin(), ref.end()) && t.size() == (int)ref.size();
+  ASSERT(ok, "el modo lazy diverge de std::set");
+
+  t.purge();
+  ASSERT(t.verify().ok && keys_de(t) == vector<int>(ref.begin(), ref.end()), "purge pierde keys");
+  for (int k : vector<int>(ref.begin(), ref.end())) t.remove(k);
+  t.set_lazy_delete(false);
+  ASSERT(t.size() == 0 && t.height() == 0, "set_lazy_delete(false) no purga los tombstones");
+}
+
+// erase_range en los bordes y contra std::set
+void probar_erase_range() {
+  BTree<int> t = BTree<int>::build_from_sorted(rango(0, 1000), 4);
+  t.erase_range(2000, 3000);
+  t.erase_range(10, 5);
+  ASSERT(t.size() == 1000, "erase_range fuera de rango elimino keys");
+  t.erase_range(-10, 0);
+  t.erase_range(999, 5000);
+  ASSERT(t.minKey() == 1 && t.maxKey() == 998 && t.size() == 998, "erase_range en los extremos");
+  t.erase_range(500, 500);
+  ASSERT(!t.search(500) && t.search(499) && t.search(501) && t.check_properties(), "erase_range de una sola key");
+  t.erase_range(-5, 5000);
+  ASSERT(t.size() == 0 && t.height() == 0, "erase_range de todo el arbol");
+
+  mt19937 rng(27);
+  bool ok = true;
+  for (int M : {3, 4, 5, 8, 33}) {
+    BTree<int> a(M);
+    set<int> ref;
+    for (int i = 0; i < 3000; i++) {
+      int k = rng() % 5000;
+      if (ref.insert(k).second) a.insert(k);
+    }
+    for (int r = 0; r < 20; r++) {
+      int b = rng() % 5000, e = b + rng() % 400;
+      a.erase_range(b, e);
+      ref.erase(ref.lower_bound(b), ref.upper_bound(e));
+      ok &= a.verify().ok && a.size() == (int)ref.size();
+    }
+    ok &= keys_de(a) == vector<int>(ref.begin(), ref.end());
+  }
+  ASSERT(ok, "erase_range diverge de std::set");
+}
+
+// split/join en los extremos y con ordenes distintos
+void probar_split_join() {
+  for (int corte : {-5, 0, 250, 499, 500, 1000}) {
+    BTree<int> t = BTree<int>::build_from_sorted(rango(0, 500), 5);
+    auto partes = t.split(corte);
+    int izq = max(0, min(corte, 500));
+    bool ok = partes.first.size() == izq && partes.second.size() == 500 - izq &&
+              partes.first.verify().ok && partes.second.verify().ok && t.size() == 0;
+    ok &= keys_de(partes.first) == rango(0, izq) && keys_de(partes.second) == rango(izq, 500);
+    partes.first.join(std::move(partes.second));
+    ok &= partes.first.size() == 500 && partes.second.size() == 0 && partes.first.check_properties();
+    ok &= keys_de(partes.first) == rango(0, 500);
+    ASSERT(ok, "split/join en " << corte);
+  }
+
+  // el size() de cada parte queda pendiente e insert/remove sobre la parte
+  // no lo desajustan
+  BTree<int> pendiente = BTree<int>::build_from_sorted(rango(0, 1000), 5);
+  auto q = pendiente.split(300);
+  q.first.insert(-1);
+  q.first.remove(5);
+  q.first.remove(5000);
+  q.second.remove(999);
+  q.second.erase_range(400, 409);
+  ASSERT(q.first.size() == 300 && q.second.size() == 689 && q.first.verify().ok && q.second.verify().ok,
+         "size() pendiente tras split con insert/remove intercalados");
+
+  // alturas muy distintas
+  BTree<int> chico = BTree<int>::build_from_sorted(rango(0, 3), 3);
+  BTree<int> grande = BTree<int>::build_from_sorted(rango(10, 5000), 3);
+  chico.join(std::move(grande));
+  ASSERT(chico.size() == 4993 && chico.verify().ok, "join de alturas distintas");
+
+  BTree<int> a = BTree<int>::build_from_sorted(rango(0, 10), 4);
+  BTree<int> b = BTree<int>::build_from_sorted(rango(5, 20), 4);
+  BTree<int> c = BTree<int>::build_from_sorted(rango(30, 40), 5);
+  bool solapa = false, orden = false;
+  try { a.join(std::move(b)); } catch (const char*) { solapa = true; }
+  try { a.join(std::move(c)); } catch (const char*) { orden = true; }
+  ASSERT(solapa && orden && a.size() == 10, "join no rechaza rangos solapados u ordenes distintos");
+}
+
+// algebra de conjuntos contra <algorithm>
+void probar_conjuntos() {
+  mt19937 rng(29);
+  bool ok = true;
+  for (int r = 0; r < 20; r++) {
+    set<int> sa, sb;
+    int na = rng() % 2000, nb = rng() % 2000, rango_keys = 1 + rng() % 4000;
+    for (int i = 0; i < na; i++) sa.insert(rng() % rango_keys);
+    for (int i = 0; i < nb; i++) sb.insert(rng() % rango_keys);
+    BTree<int> a = BTree<int>::build_from_sorted(vector<int>(sa.begin(), sa.end()), 5);
+    BTree<int> b = BTree<int>::build_from_sorted(vector<int>(sb.begin(), sb.end()), 5);
+
+    vector<int> u, in, d;
+    std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), back_inserter(u));
+    std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), back_inserter(in));
+    std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), back_inserter(d));
+    BTree<int> tu = a.set_union(b), ti = a.set_intersection(b), td = a.set_difference(b);
+    ok &= keys_de(tu) == u && keys_de(ti) == in && keys_de(td) == d;
+    ok &= tu.verify().ok && ti.verify().ok && td.verify().ok;
+
+    a.merge(std::move(b));
+    ok &= keys_de(a) == u && a.size() == (int)u.size() && b.size() == 0 && a.verify().ok;
+  }
+  ASSERT(ok, "set_union/set_intersection/set_difference/merge divergen de <algorithm>");
+
+  // merge de rangos disjuntos en ambos sentidos usa join
+  BTree<int> bajo = BTree<int>::build_from_sorted(rango(0, 100), 4);
+  BTree<int> alto = BTree<int>::build_from_sorted(rango(100, 200), 4);
+  alto.merge(std::move(bajo));
+  ASSERT(keys_de(alto) == rango(0, 200) && alto.check_properties(), "merge de rangos disjuntos");
+}
+
+// reportes de verify sobre arboles validos y corruptos
+void probar_verify() {
+  BTree<int> vacio(4);
+  ASSERT(vacio.verify().ok, "verify de un arbol vacio");
+
+  BTree<int> t = BTree<int>::build_from_sorted(rango(0, 200000), 6);
+  PropertyReport r = t.verify();
+  ASSERT(r.ok && r.violation == PropertyReport::NONE && r.nodes_checked > 200000 / 5,
+         "verify de un arbol valido grande");
+  PropertyReport s = t.verify_sampled(chrono::microseconds(200), 1);
+  ASSERT(s.ok && s.paths_checked >= 1, "verify_sampled de un arbol valido");
+
+  // se corrompe una key a traves del iterador: rompe el orden dentro de su
+  // nodo o la cota del separador del padre
+  BTree<int> c = BTree<int>::build_from_sorted(rango(0, 1000), 4);
+  auto it = c.lower_bound(500);
+  const_cast<int&>(*it) = 5000;
+  PropertyReport rc = c.verify();
+  ASSERT(!rc.ok && (rc.violation == PropertyReport::KEY_ORDER || rc.violation == PropertyReport::SEPARATOR_BOUND) &&
+         !rc.path.empty() && !rc.message.empty(), "verify no reporta la key corrupta");
+  ASSERT(!c.check_properties(), "check_properties no detecta la key corrupta");
+}
+
+// FrozenBTree contra std::lower_bound
+void probar_frozen() {
+  mt19937 rng(31);
+  bool ok = true;
+  for (int n : {1, 15, 16, 17, 272, 273, 5000}) {
+    set<int> s;
+    while ((int)s.size() < n) s.insert(rng() % (10 * n));
+    vector<int> v(s.begin(), s.end());
+    FrozenBTree<int> f(v);
+    ok &= f.size() == n && f.minKey() == v.front() && f.maxKey() == v.back();
+    for (int q = -2; q <= 10 * n + 2; q++) {
+      const int* p = f.lower_bound(q);
+      auto e = std::lower_bound(v.begin(), v.end(), q);
+      ok &= (p == f.end()) == (e == v.end()) && (p == f.end() || *p == *e);
+      ok &= f.search(q) == s.count(q);
+    }
+    ok &= f.rangeSearch(n, 3 * n) == vector<int>(s.lower_bound(n), s.upper_bound(3 * n));
+    BTree<int> t = f.thaw(5);
+    ok &= keys_de(t) == v && t.verify().ok;
+  }
+  ASSERT(ok, "FrozenBTree diverge de std::lower_bound");
+
+  // keys por encima del relleno o iguales al maximo del tipo
+  vector<double> reales;
+  for (int i = 0; i < 1000; i++) reales.push_back(i * 0.5);
+  FrozenBTree<double> fd(reales);
+  ASSERT(!fd.search(INFINITY) && fd.lower_bound(INFINITY) == fd.end() && *fd.lower_bound(-INFINITY) == 0.0 &&
+         fd.rangeSearch(499, INFINITY).size() == 2, "FrozenBTree<double> con keys infinitas");
+  reales.push_back(numeric_limits<double>::max());
+  reales.push_back(INFINITY);
+  FrozenBTree<double> fi(reales);
+  ASSERT(fi.search(INFINITY) && fi.search(numeric_limits<double>::max()) && fi.maxKey() == INFINITY,
+         "FrozenBTree<double> que contiene infinito");
+  vector<int> enteros = rango(0, 300);
+  enteros.push_back(numeric_limits<int>::max());
+  FrozenBTree<int> fm(enteros);
+  ASSERT(fm.search(numeric_limits<int>::max()) && *fm.lower_bound(301) == numeric_limits<int>::max(),
+         "FrozenBTree<int> con el maximo del tipo");
+
+  FrozenBTree<int> vacio(vector<int>{});
+  bool lanza = false;
+  try { vacio.minKey(); } catch (const char*) { lanza = true; }
+  ASSERT(vacio.lower_bound(3) == vacio.end() && !vacio.search(3) && lanza, "FrozenBTree vacio");
+
+  BTree<int> t(4);
+  for (int k : {9, 3, 7, 1}) t.insert(k);
+  t.set_lazy_delete(true);
+  t.remove(7);
+  FrozenBTree<int> g(t);
+  ASSERT(vector<int>(g.begin(), g.end()) == vector<int>({1, 3, 9}), "FrozenBTree desde un BTree con tombstones");
+}
+
+// orden de los recorridos y division/rebalanceo de shards
+void probar_sharded() {
+  ShardedBTree<int> rangos(5, vector<int>{1000, 2000, 3000}, 500);
+  ShardedBTree<int> hash(5, 7);
+  mt19937 rng(32);
+  set<int> ref;
+  for (int i = 0; i < 4000; i++) {
+    int k = rng() % 5000;
+    if (!ref.insert(k).second) continue;
+    rangos.insert(k);
+    hash.insert(k);
+  }
+  vector<int> esperado(ref.begin(), ref.end());
+  ASSERT(rangos.keys() == esperado && hash.keys() == esperado, "keys() no queda ordenado");
+  ASSERT(rangos.rangeSearch(1500, 3500) == vector<int>(ref.lower_bound(1500), ref.upper_bound(3500)) &&
+         hash.rangeSearch(1500, 3500) == vector<int>(ref.lower_bound(1500), ref.upper_bound(3500)),
+         "rangeSearch entre shards no queda ordenado");
+  ASSERT(rangos.shard_count() > 4 && rangos.check_properties() && hash.check_properties(),
+         "los shards grandes no se dividen");
+  bool chicos = true;
+  for (int s : rangos.shard_sizes()) chicos &= s <= 500;
+  ASSERT(chicos && rangos.size() == (int)ref.size(), "shard_sizes supera max_por_shard");
+
+  for (int k : esperado) {
+    if (k >= 1000) rangos.remove(k);
+  }
+  rangos.rebalance();
+  ASSERT(rangos.check_properties() && rangos.keys() == vector<int>(ref.begin(), ref.lower_bound(1000)),
+         "rebalance pierde keys");
+
+  // al vaciarse todos los shards el promedio es 0 y aun asi se unen
+  ShardedBTree<int> vaciar(5, vector<int>{}, 300);
+  for (int k = 0; k < 20000; k++) vaciar.insert(k);
+  int antes = vaciar.shard_count();
+  vector<int> primeros = vaciar.rangeSearch(0, 99);
+  for (int k = 0; k < 20000; k++) vaciar.remove(k);
+  vaciar.rebalance();
+  ASSERT(antes > 50 && primeros == rango(0, 100) && vaciar.shard_count() == 1 && vaciar.size() == 0 &&
+         vaciar.keys().empty() && vaciar.check_properties(), "rebalance no une los shards vacios");
+
+  // una key repetida mas de max_por_shard veces: la racha de la mediana
+  // arranca en la primera key, se corta al final de la racha y un shard con
+  // una sola key distinta no se parte (check_properties no admite duplicados)
+  ShardedBTree<int> repetidas(5, vector<int>{}, 10);
+  for (int i = 0; i < 12; i++) repetidas.insert(7);
+  ASSERT(repetidas.shard_count() == 1 && repetidas.keys() == vector<int>(12, 7),
+         "division de un shard con una sola key distinta");
+  for (int i = 0; i < 3; i++) repetidas.insert(9);
+  repetidas.rebalance(1.0);
+  vector<int> siete_nueve(12, 7);
+  siete_nueve.insert(siete_nueve.end(), 3, 9);
+  ASSERT(repetidas.shard_sizes() == vector<int>({12, 3}) && repetidas.keys() == siete_nueve,
+         "division con la racha de la mediana al inicio");
+
+  // inserciones concurrentes de bloques disjuntos
+  ShardedBTree<int> conc(8, vector<int>{25000, 50000, 75000}, 10000);
+  vector<thread> hilos;
+  for (int h = 0; h < 4; h++) {
+    hilos.emplace_back([&conc, h]() {
+      for (int i = 0; i < 25000; i++) conc.insert(i * 4 + h);
+    });
+  }
+  for (thread& h : hilos) h.join();
+  ASSERT(conc.size() == 100000 && conc.keys() == rango(0, 100000) && conc.check_properties(),
+         "inserciones concurrentes");
+}
+
+// insert/find con hint y su invalidacion
+void probar_hint() {
+  BTree<int> t(6);
+  auto hint = t.end();
+  for (int i = 0; i < 10000; i++) t.insert(hint, i);
+  ASSERT(t.size() == 10000 && t.verify().ok && *hint == 9999, "insert con hint secuencial");
+
+  bool ok = true;
+  auto f = t.begin();
+  for (int i = 0; i < 10000; i += 3) ok &= t.find(f, i) && *f == i;
+  ok &= !t.find(f, 20000) && f == t.end();
+  ASSERT(ok, "find con hint");
+
+  // el hint queda invalido tras modificaciones de otras operaciones
+  mt19937 rng(33);
+  set<int> ref(t.begin(), t.end());
+  auto h = t.begin();
+  for (int i = 0; i < 20000; i++) {
+    int k = rng() % 30000;
+    switch (rng() % 4) {
+      case 0: if (ref.insert(k).second) t.insert(h, k); break;
+      case 1: t.remove(k); ref.erase(k); break;
+      case 2: ok &= t.find(h, k) == (ref.count(k) > 0); break;
+      default: ok &= t.search(k) == (ref.count(k) > 0);
+    }
+  }
+  ok &= keys_de(t) == vector<int>(ref.begin(), ref.end()) && t.verify().ok;
+  ASSERT(ok, "hint con splits y fusiones intercalados");
+
+  // search mueve el dedo interno; lo intercalan inserts con hint que parten
+  // hojas y tombstones que no deben encontrarse
+  BTree<int> s(4);
+  s.set_lazy_delete(true);
+  set<int> ref_s;
+  auto hs = s.end();
+  for (int i = 0; i < 5000; i++) {
+    s.insert(hs, 2 * i);
+    ref_s.insert(2 * i);
+  }
+  for (int i = 0; i < 5000; i += 3) {
+    s.remove(2 * i);
+    ref_s.erase(2 * i);
+  }
+  for (int k = 0; k < 10000; k++) {
+    ok &= s.search(k) == (ref_s.count(k) > 0);
+    if (k % 7 == 1 && ref_s.insert(k).second) s.insert(hs, k);
+  }
+  ok &= keys_de(s) == vector<int>(ref_s.begin(), ref_s.end()) && s.verify().ok;
+  ASSERT(ok, "search secuencial con el dedo interno");
+}
+
+// el filtro nunca da falsos negativos
+void probar_filtro() {
+  BTree<int> t(5);
+  t.enable_filter();
+  mt19937 rng(34);
+  set<int> ref;
+  bool ok = true;
+  for (int i = 0; i < 30000; i++) {
+    int k = rng() % 20000;
+    if (rng() % 3) {
+      if (ref.insert(k).second) t.insert(k);
+    } else {
+      t.remove(k);
+      ref.erase(k);
+    }
+    if (i % 7 == 0) {
+      int q = rng() % 20000;
+      ok &= t.search(q) == (ref.count(q) > 0) && (t.find(q) != t.end()) == (ref.count(q) > 0);
+    }
+  }
+  for (int k : ref) ok &= t.search(k);
+  ASSERT(ok, "el filtro da falsos negativos");
+
+  const BloomFilter<int>& filtro = t.filter();
+  ASSERT(filtro.enabled() && filtro.queries > 0 && filtro.rejected > 0 &&
+         filtro.rejected + filtro.false_positives <= filtro.queries, "contadores del filtro");
+
+  auto partes = t.split(10000);
+  for (int k : ref) ok &= (k < 10000 ? partes.first : partes.second).search(k);
+  ASSERT(ok, "el filtro de las partes de split da falsos negativos");
+
+  // join y merge que traen keys de otro arbol deben dejar el filtro obsoleto
+  auto encuentra = [](BTree<int>& arbol, int desde, int hasta) {
+    bool todas = arbol.size() == hasta - desde;
+    for (int k = desde; k < hasta; k++) todas &= arbol.search(k);
+    return todas;
+  };
+  BTree<int> vacio(4);
+  vacio.enable_filter();
+  vacio.join(BTree<int>::build_from_sorted(rango(0, 20), 4));
+  ASSERT(encuentra(vacio, 0, 20), "join sobre un arbol vacio con filtro");
+  BTree<int> vacio2(4);
+  vacio2.enable_filter();
+  vacio2.merge(BTree<int>::build_from_sorted(rango(0, 20), 4));
+  ASSERT(encuentra(vacio2, 0, 20), "merge sobre un arbol vacio con filtro");
+  BTree<int> alto = BTree<int>::build_from_sorted(rango(100, 120), 4);
+  alto.enable_filter();
+  alto.merge(BTree<int>::build_from_sorted(rango(0, 100), 4));
+  ASSERT(encuentra(alto, 0, 120) && alto.check_properties(), "merge de un rango menor con filtro");
+  alto.merge(BTree<int>::build_from_sorted(rango(120, 140), 4));
+  ASSERT(encuentra(alto, 0, 140), "merge de un rango mayor con filtro");
+
+  // corrida diferencial: dos arboles con filtro que se parten, unen y mezclan
+  BTree<int> x(5), y(5);
+  x.enable_filter();
+  y.enable_filter();
+  set<int> rx, ry;
+  for (int i = 0; i < 3000; i++) {
+    int k = rng() % 4000;
+    switch (rng() % 8) {
+      case 0: case 1: case 2:
+        if (rx.insert(k).second) x.insert(k);
+        break;
+      case 3:
+        if (ry.insert(k).second) y.insert(k);
+        break;
+      case 4:
+        x.remove(k);
+        rx.erase(k);
+        break;
+      case 5: {
+        // x se queda con las keys < k y el resto se mezcla en y
+        auto partes = x.split(k);
+        x = std::move(partes.first);
+        y.merge(std::move(partes.second));
+        for (auto it = rx.lower_bound(k); it != rx.end(); it = rx.erase(it)) ry.insert(*it);
+        break;
+      }
+      case 6:
+        x.merge(std::move(y));
+        rx.insert(ry.begin(), ry.end());
+        ry.clear();
+        break;
+      default: {
+        int q = rng() % 4000;
+        ok &= x.search(q) == (rx.count(q) > 0) && y.search(q) == (ry.count(q) > 0);
+      }
+    }
+  }
+  for (int k : rx) ok &= x.search(k);
+  for (int k : ry) ok &= y.search(k);
+  ASSERT(ok && x.verify().ok && y.verify().ok, "el filtro da falsos negativos tras split/join/merge");
+
+  // tasa de falsos positivos con 10 bits por key de capacidad: la capacidad
+  // es el doble de las keys vivas, asi que se mide recien construido y lleno
+  BTree<int> medido(16);
+  for (int i = 0; i < 50000; i++) medido.insert(2 * i);
+  medido.enable_filter(10);
+  auto tasa = [&medido]() {
+    long long fp = medido.filter().false_positives, rechazadas = medido.filter().rejected;
+    for (int i = 0; i < 200000; i++) medido.search(-1 - 2 * i);
+    fp = medido.filter().false_positives - fp;
+    rechazadas = medido.filter().rejected - rechazadas;
+    return (double)fp / (fp + rechazadas);
+  };
+  double recien = tasa();
+  int capacidad = medido.filter().capacity();
+  for (int i = 50000; i < capacidad; i++) medido.insert(2 * i);
+  double lleno = tasa();
+  ASSERT(capacidad == 100000 && medido.filter().capacity() == capacidad && recien < 0.001 && lleno < 0.02,
+         "tasa de falsos positivos: " << recien << " recien construido, " << lleno << " lleno");
+
+  t.disable_filter();
+  ASSERT(!t.filter().enabled(), "disable_filter");
+}
+
+// multiset: ocurrencias por key
+void probar_multiset() {
+  BTree<int> t(4, true);
+  for (int i = 0; i < 1000; i++) t.insert(i % 10);
+  ASSERT(t.size() == 1000 && t.count(3) == 100 && t.count(42) == 0 && t.height() == 1,
+         "insert de keys repetidas no incrementa el contador");
+  t.erase_one(3);
+  t.erase_all(4);
+  ASSERT(t.count(3) == 99 && t.count(4) == 0 && !t.search(4) && t.size() == 899, "erase_one/erase_all");
+  ASSERT(t.rangeSearch(2, 3).size() == 199 && t.begin().count() == 100, "rangeSearch/iterador en multiset");
+
+  mt19937 rng(35);
+  bool ok = true;
+  for (int lazy = 0; lazy < 2; lazy++) {
+    BTree<int> m(5, true);
+    m.set_lazy_delete(lazy);
+    map<int, int> ref;
+    int total = 0;
+    for (int i = 0; i < 20000; i++) {
+      int k = rng() % 300, op = rng() % 10;
+      if (op < 6) {
+        m.insert(k);
+        ref[k]++;
+        total++;
+      } else if (op < 8) {
+        m.erase_one(k);
+        if (ref.count(k)) {
+          total--;
+          if (--ref[k] == 0) ref.erase(k);
+        }
+      } else {
+        m.erase_all(k);
+        if (ref.count(k)) {
+          total -= ref[k];
+          ref.erase(k);
+        }
+      }
+      if (i % 1000 == 0) ok &= m.verify().ok && m.size() == total;
+    }
+    for (auto& p : ref) ok &= m.count(p.first) == p.second;
+    auto partes = m.split(150);
+    ok &= partes.first.size() + partes.second.size() == total;
+  }
+  ASSERT(ok, "el multiset diverge de std::map");
+
+  // congelar y descongelar conserva las ocurrencias
+  BTree<int> repetidas(5, true);
+  for (int k : {4, 1, 4, 9, 4, 1}) repetidas.insert(k);
+  FrozenBTree<int> congelado(repetidas);
+  BTree<int> descongelado = congelado.thaw(5);
+  ASSERT(congelado.size() == 6 && congelado.count(4) == 3 && congelado.count(1) == 2 && congelado.count(5) == 0 &&
+         congelado.rangeSearch(1, 4) == vector<int>({1, 1, 4, 4, 4}) && descongelado.is_multiset() &&
+         descongelado.size() == 6 && descongelado.count(4) == 3 && descongelado.count(9) == 1 &&
+         descongelado.verify().ok, "FrozenBTree pierde las ocurrencias del multiset");
+  BTree<int> vacio(5, true);
+  FrozenBTree<int> congelado_vacio(vacio);
+  BTree<int> descongelado_vacio = congelado_vacio.thaw(5);
+  descongelado_vacio.insert(2);
+  descongelado_vacio.insert(2);
+  ASSERT(descongelado_vacio.is_multiset() && descongelado_vacio.count(2) == 2, "thaw de un multiset vacio");
+
+  // count de keys ausentes que pasan el filtro cuenta como falso positivo
+  BTree<int> filtrado(8, true);
+  for (int i = 0; i < 1000; i++) filtrado.insert(2 * i);
+  filtrado.enable_filter(1);
+  for (int i = 0; i < 20000; i++) filtrado.count(2 * i + 1);
+  const BloomFilter<int>& f = filtrado.filter();
+  ASSERT(f.false_positives > 0 && f.rejected + f.false_positives == 20000 &&
+         f.false_positive_rate() == (double)f.false_positives / 20000,
+         "count no registra los falsos positivos del filtro");
+}
+
+int main() {
+  probar_lazy_delete();
+  probar_erase_range();
+  probar_split_join();
+  probar_conjuntos();
+  probar_verify();
+  probar_frozen();
+  probar_sharded();
+  probar_hint();
+  probar_filtro();
+  probar_multiset();
+
+  cout << TrueAsserts << "/" << TotalAsserts << " pruebas correctas" << endl;
+  return TrueAsserts == TotalAsserts ? 0 : 1;
+}